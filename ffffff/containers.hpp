@@ -0,0 +1,226 @@
+#ifndef UNDERSCORE_CPP_CONTAINERS_HPP
+#define UNDERSCORE_CPP_CONTAINERS_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __has_include(<flat_set>)
+#include <flat_set>
+#endif
+
+namespace fff {
+
+    /**
+    * determines whether A can be given to a functor to allocate its result :
+    * an allocator of any value type, or a std::pmr::memory_resource *
+    */
+    template<typename A>
+    concept allocator_like = std::convertible_to<A, std::pmr::memory_resource *>
+        or requires (A &a) {
+            typename A::value_type;
+            a.allocate(std::size_t(1));
+        };
+}
+
+/*
+* fff::liated::rebind_container Reducible_TD
+*/
+namespace fff::liated {
+
+    /**
+    * P\<T> -> P\<U> for the T-dependent parameters of a container, e.g. std::less\<T>, std::hash\<T>.
+    * Any other parameter (std::less<>, a user-defined comparator, ...) is kept.
+    */
+    template<typename X, typename T, typename U>
+    struct rebind_param {
+        using type = X;
+    };
+
+    template<template<class> class P, typename T, typename U>
+    struct rebind_param<P<T>, T, U> {
+        using type = P<U>;
+    };
+
+    template<typename X, typename T, typename U>
+    using rebind_param_t = typename rebind_param<X, T, U>::type;
+
+    /**
+    * The allocator of U made of A. A std::pmr::memory_resource * makes a std::pmr::polymorphic_allocator.
+    */
+    template<typename A, typename U>
+    struct rebind_alloc {
+        using type = typename std::allocator_traits<A>::template rebind_alloc<U>;
+    };
+
+    template<typename A, typename U>
+        requires std::convertible_to<A, std::pmr::memory_resource *>
+    struct rebind_alloc<A, U> {
+        using type = std::pmr::polymorphic_allocator<U>;
+    };
+
+    template<typename A, typename U>
+    using rebind_alloc_t = typename rebind_alloc<A, U>::type;
+
+    /**
+    * Cont = C\<T, ...> -> C\<U, ..., (allocator of U made of A)>
+    * for the allocator-aware std::(containers) : vector, deque, list, forward_list, basic_string,
+    * set, multiset, unordered_set and unordered_multiset.
+    */
+    template<class Cont, typename U, typename A>
+    struct rebind_container;
+
+    template<template<class, class> class C, typename T, class CA, typename U, typename A>
+    struct rebind_container<C<T, CA>, U, A> {
+        using type = C<U, rebind_alloc_t<A, U>>;
+    };
+
+    template<template<class, class, class> class C, typename T, class P, class CA, typename U, typename A>
+    struct rebind_container<C<T, P, CA>, U, A> {
+        using type = C<U, rebind_param_t<P, T, U>, rebind_alloc_t<A, U>>;
+    };
+
+    template<template<class, class, class, class> class C, typename T, class H, class E, class CA, typename U, typename A>
+    struct rebind_container<C<T, H, E, CA>, U, A> {
+        using type = C<U, rebind_param_t<H, T, U>, rebind_param_t<E, T, U>, rebind_alloc_t<A, U>>;
+    };
+
+    template<class Cont, typename U, typename A>
+    using rebind_container_t = typename rebind_container<Cont, U, A>::type;
+
+    /**
+    * M = C\<K, V, ...> -> C\<K, U, ..., (allocator of std::pair\<const K, U> made of M's)>
+    * for std::map, std::multimap, std::unordered_map and std::unordered_multimap.
+    */
+    template<class M, typename U>
+    struct rebind_mapped;
+
+    template<template<class, class, class, class> class C, typename K, typename V, class P, class MA, typename U>
+    struct rebind_mapped<C<K, V, P, MA>, U> {
+        using type = C<K, U, P, rebind_alloc_t<MA, std::pair<const K, U>>>;
+    };
+
+    template<template<class, class, class, class, class> class C, typename K, typename V, class H, class E, class MA, typename U>
+    struct rebind_mapped<C<K, V, H, E, MA>, U> {
+        using type = C<K, U, H, E, rebind_alloc_t<MA, std::pair<const K, U>>>;
+    };
+
+    template<class M, typename U>
+    using rebind_mapped_t = typename rebind_mapped<M, U>::type;
+
+    /**
+    * determines whether a container like Cont, of U, can allocate with A
+    */
+    template<class Cont, typename U, typename A>
+    concept rebindable = allocator_like<A> and requires { typename rebind_container_t<Cont, U, A>; };
+}
+
+/*
+* fff::liated build strategies Reducible_TD
+*
+* The cheapest way to fill each kind of result container, element by element or in bulk :
+* reserve for vector and string, reserve for the unordered containers (so that they never rehash),
+* a hinted insert at the end for ordered containers whose elements arrive in order,
+* and sort + unique + one linear construction for ordered containers whose elements arrive in any order.
+*/
+namespace fff::liated {
+
+    /**
+    * determines whether C keeps its elements sorted by C::key_compare : std::set, std::multiset, std::flat_set, ...
+    */
+    template<class C>
+    concept ordered_container = requires (C &c, const typename C::value_type &v) {
+        typename C::key_compare;
+        c.value_comp();
+        c.emplace_hint(c.end(), v);
+    };
+
+    /**
+    * determines whether C rejects an element equivalent to one it has : std::set, std::unordered_set, ...
+    */
+    template<class C>
+    concept unique_container = requires (C &c, const typename C::value_type &v) {
+        { c.insert(v).second } -> std::convertible_to<bool>;
+    };
+
+    /**
+    * determines whether the elements of From arrive in the order of To, i.e. From is sorted by the comparator of To
+    */
+    template<class From, class To>
+    concept same_order = ordered_container<From> and ordered_container<To>
+        and std::is_same_v<typename From::key_compare, typename To::key_compare>
+        and std::is_same_v<typename From::value_type, typename To::value_type>;
+
+    /**
+    * Makes room in out for n more elements, if out can : reserve for vector, string and the unordered containers.
+    */
+    template<class C>
+    constexpr void reserve_more(C &out, std::size_t n) {
+        if constexpr (requires { out.reserve(n); }) {
+            out.reserve(std::ranges::size(out) + n);
+        }
+    }
+
+    /**
+    * Appends v to out : push_back for sequences, a hinted insert at the end for ordered containers
+    * (amortized O(1) when the elements arrive in order), insert otherwise.
+    */
+    template<class C, typename V>
+    constexpr void append(C &out, V &&v) {
+        if constexpr (requires { out.push_back(std::forward<V>(v)); }) {
+            out.push_back(std::forward<V>(v));
+        } else if constexpr (ordered_container<C>) {
+            out.emplace_hint(out.end(), std::forward<V>(v));
+        } else {
+            out.insert(std::forward<V>(v));
+        }
+    }
+
+    /**
+    * Appends every element of buf to out, in bulk.
+    * An ordered out gets buf sorted (and made unique) by its comparator first,
+    * then one linear construction if out is empty, or hinted inserts at the end otherwise.
+    * The sort is stable, so equivalent elements keep their order, and a unique out keeps the first of them,
+    * as inserting one by one would.
+    */
+    template<class C, typename T, class BA>
+    void append_all(C &out, std::vector<T, BA> &&buf) {
+        if constexpr (ordered_container<C>) {
+            const auto comp = out.value_comp();
+            std::stable_sort(buf.begin(), buf.end(), comp);
+
+            if constexpr (unique_container<C>) {
+                buf.erase(std::unique(buf.begin(), buf.end(), [&comp](const T &a, const T &b) {
+                    return not comp(a, b) and not comp(b, a);
+                }), buf.end());
+            }
+
+#if defined(__cpp_lib_flat_set)
+            if constexpr (requires { out.insert(std::sorted_unique, buf.begin(), buf.end()); }) {
+                out.insert(std::sorted_unique, std::make_move_iterator(buf.begin()), std::make_move_iterator(buf.end()));
+                return;
+            }
+#endif
+            if (out.empty()) {
+                out = C(std::make_move_iterator(buf.begin()), std::make_move_iterator(buf.end()),
+                        out.key_comp(), out.get_allocator());
+            } else {
+                for (auto &v : buf) {
+                    out.emplace_hint(out.end(), std::move(v));
+                }
+            }
+        } else {
+            reserve_more(out, buf.size());
+            for (auto &v : buf) {
+                append(out, std::move(v));
+            }
+        }
+    }
+}
+
+#endif//UNDERSCORE_CPP_CONTAINERS_HPP
@@ -0,0 +1,305 @@
+#ifndef UNDERSCORE_CPP_DYNAMIC_PIPELINE_HPP
+#define UNDERSCORE_CPP_DYNAMIC_PIPELINE_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "function.hpp"
+
+/*
+* fff::dynamic_pipeline Reducible_TD
+*
+* Pipelines assembled at runtime from a spec like "parse|filter:nonzero|map:scale",
+* out of the named, typed stages of a fff::stage_registry.
+* A run of stages for which a fused segment (usually a compile-time fff::Pipeline) was registered
+* runs as that one segment, so the hot parts of a dynamic pipeline cost about what the static one costs.
+*/
+namespace fff {
+
+    namespace liated {
+
+        /**
+        * One type-erased step of a dynamic pipeline.\n
+        * run(in, next, result) takes the value at in (an object of type in, which it may move from)
+        * and passes what it makes to next->run(..., next + 1, result), or nothing if it drops the value.
+        * The last step, whose next is end, stores the value into result, a std::optional of its out.
+        */
+        struct DynSegment {
+            function<void(void *, const DynSegment *, const DynSegment *, void *)> run;
+            std::type_index in;
+            std::type_index out;
+            std::size_t stages; // how many stages of the spec it covers
+        };
+
+        template<typename T>
+        void pass_on(T &&y, const DynSegment *next, const DynSegment *end, void *result) {
+            if (next == end) {
+                *static_cast<std::optional<std::remove_cvref_t<T>> *>(result) = std::optional<std::remove_cvref_t<T>>(std::move(y));
+            } else {
+                next->run(std::addressof(y), next + 1, end, result);
+            }
+        }
+
+        template<typename R>
+        struct maybe_value : std::false_type {
+            using type = R;
+        };
+
+        template<typename T>
+        struct maybe_value<std::optional<T>> : std::true_type {
+            using type = T;
+        };
+
+        /**
+        * The value that a map stage F passes on from an In; a std::optional result drops the value when empty.
+        */
+        template<typename In, class F>
+        using stage_output_t = std::remove_cvref_t<typename maybe_value<std::remove_cvref_t<std::invoke_result_t<const F &, In &&>>>::type>;
+
+        template<typename In, class F>
+        auto map_segment(F f, std::size_t stages) -> DynSegment {
+            using Out = stage_output_t<In, F>;
+
+            return DynSegment{
+                [f = std::move(f)](void *in, const DynSegment *next, const DynSegment *end, void *result) {
+                    if constexpr (maybe_value<std::remove_cvref_t<std::invoke_result_t<const F &, In &&>>>::value) {
+                        std::optional<Out> y = std::invoke(f, std::move(*static_cast<In *>(in)));
+                        if (not y) {
+                            return;
+                        }
+                        pass_on(std::move(*y), next, end, result);
+                    } else {
+                        pass_on(Out(std::invoke(f, std::move(*static_cast<In *>(in)))), next, end, result);
+                    }
+                },
+                typeid(In), typeid(Out), stages
+            };
+        }
+
+        template<typename In, class P>
+        auto filter_segment(P p) -> DynSegment {
+            return DynSegment{
+                [p = std::move(p)](void *in, const DynSegment *next, const DynSegment *end, void *result) {
+                    if (std::invoke(p, std::as_const(*static_cast<In *>(in)))) {
+                        pass_on(std::move(*static_cast<In *>(in)), next, end, result);
+                    }
+                },
+                typeid(In), typeid(In), 1
+            };
+        }
+
+        [[noreturn]] inline void bad_spec(std::string_view spec, std::string_view what) {
+            throw std::invalid_argument("fff::dynamic_pipeline \"" + std::string(spec) + "\" : " + std::string(what));
+        }
+
+        /**
+        * Splits a spec at '|' into stage names, trimming the spaces around each.
+        * @throw std::invalid_argument for an empty stage name
+        */
+        inline auto split_spec(std::string_view spec) -> std::vector<std::string> {
+            std::vector<std::string> ret;
+
+            std::size_t pos = 0;
+            while (true) {
+                const std::size_t bar = std::min(spec.find('|', pos), spec.size());
+
+                std::string_view name = spec.substr(pos, bar - pos);
+                name.remove_prefix(std::min(name.find_first_not_of(" \t"), name.size()));
+                name.remove_suffix(name.size() - std::min(name.find_last_not_of(" \t") + 1, name.size()));
+                if (name.empty()) {
+                    bad_spec(spec, "empty stage name");
+                }
+                ret.emplace_back(name);
+
+                if (bar == spec.size()) {
+                    return ret;
+                }
+                pos = bar + 1;
+            }
+        }
+
+        inline auto join_spec(const std::vector<std::string> &names, std::size_t first, std::size_t last) -> std::string {
+            std::string ret = names[first];
+            for (std::size_t i = first + 1; i < last; ++i) {
+                ret += '|';
+                ret += names[i];
+            }
+            return ret;
+        }
+    }
+
+    /**
+    * Named, typed stages that fff::dynamic_pipeline is assembled from.\n
+    * add(name, f) registers a stage by its full name, map(name, f) as "map:name", filter(name, p) as "filter:name".
+    * A stage that returns a std::optional drops the value when it is empty.
+    * fuse(spec, f) registers f to run in place of the stages of spec, wherever they appear together.
+    * Registering a stage again drops the fused segments that cover it.
+    * Registering is not synchronized; assembling is read-only, so any number of threads may assemble at once.
+    * @example fff::stage_registry reg;
+    * reg.add<std::string>("parse", parse);
+    * reg.filter<int>("nonzero", [](int n) {return n != 0;});
+    * reg.map<int>("scale", [](int n) {return n * 10;});
+    * fff::dynamic_pipeline<std::string, int> p(reg, "parse|filter:nonzero|map:scale");
+    * p("3") == 30, p("0") == std::nullopt
+    */
+    class stage_registry {
+        std::map<std::string, liated::DynSegment, std::less<>> stages;
+        std::map<std::string, liated::DynSegment, std::less<>> fused;
+        std::size_t longest_fused = 0;
+
+        void insert(std::string name, liated::DynSegment seg) {
+            if (name.empty() or name.find('|') != std::string::npos) {
+                throw std::invalid_argument("fff::stage_registry : bad stage name \"" + name + "\"");
+            }
+            // a fused segment stands for the stages as they were, so it goes with any of them
+            std::erase_if(fused, [&name](const auto &kv) {
+                const auto names = liated::split_spec(kv.first);
+                return std::ranges::find(names, name) != names.end();
+            });
+            stages.insert_or_assign(std::move(name), std::move(seg));
+        }
+
+        auto find(std::string_view spec, const std::string &name) const -> const liated::DynSegment & {
+            auto it = stages.find(name);
+            if (it == stages.end()) {
+                liated::bad_spec(spec, "unknown stage \"" + name + "\"");
+            }
+            return it->second;
+        }
+
+    public:
+        /**
+        * Registers f : In -> Out (or std::optional<Out>) as the stage name.
+        */
+        template<typename In, class F>
+            requires std::is_invocable_v<const std::decay_t<F> &, In &&>
+        void add(std::string name, F &&f) {
+            insert(std::move(name), liated::map_segment<In>(std::decay_t<F>(std::forward<F>(f)), 1));
+        }
+
+        /**
+        * Registers f : In -> Out (or std::optional<Out>) as the stage "map:name".
+        */
+        template<typename In, class F>
+            requires std::is_invocable_v<const std::decay_t<F> &, In &&>
+        void map(std::string_view name, F &&f) {
+            add<In>("map:" + std::string(name), std::forward<F>(f));
+        }
+
+        /**
+        * Registers p : const In & -> bool as the stage "filter:name", which passes on the values that p accepts.
+        */
+        template<typename In, class P>
+            requires std::predicate<const std::decay_t<P> &, const In &>
+        void filter(std::string_view name, P &&p) {
+            insert("filter:" + std::string(name), liated::filter_segment<In>(std::decay_t<P>(std::forward<P>(p))));
+        }
+
+        /**
+        * Registers f to run in place of the registered stages of spec, wherever they appear one after another.
+        * f takes what the first stage takes and returns what the last stage passes on (or a std::optional of it).
+        * @throw std::invalid_argument if spec names an unknown stage, or if the types do not match
+        * @example reg.fuse<int>("filter:nonzero|map:scale", [](int n) {return n ? std::optional(n * 10) : std::nullopt;});
+        */
+        template<typename In, class F>
+            requires std::is_invocable_v<const std::decay_t<F> &, In &&>
+        void fuse(std::string_view spec, F &&f) {
+            const auto names = liated::split_spec(spec);
+
+            std::type_index cur = typeid(In);
+            for (const auto &name : names) {
+                const auto &seg = find(spec, name);
+                if (seg.in != cur) {
+                    liated::bad_spec(spec, "stage \"" + name + "\" does not take the type before it");
+                }
+                cur = seg.out;
+            }
+            if (cur != typeid(liated::stage_output_t<In, std::decay_t<F>>)) {
+                liated::bad_spec(spec, "the fused segment does not make what the last stage makes");
+            }
+
+            fused.insert_or_assign(liated::join_spec(names, 0, names.size()),
+                                   liated::map_segment<In>(std::decay_t<F>(std::forward<F>(f)), names.size()));
+            longest_fused = std::max(longest_fused, names.size());
+        }
+
+        /**
+        * The segments of spec, from In to Out : at every stage, the longest fused segment that starts there, or else the stage.
+        * @throw std::invalid_argument if spec is empty, names an unknown stage, or if the types do not match
+        */
+        auto assemble(std::string_view spec, std::type_index in, std::type_index out) const -> std::vector<liated::DynSegment> {
+            const auto names = liated::split_spec(spec);
+
+            std::vector<liated::DynSegment> ret;
+            std::type_index cur = in;
+
+            for (std::size_t i = 0; i < names.size();) {
+                const liated::DynSegment *seg = nullptr;
+                for (std::size_t len = std::min(longest_fused, names.size() - i); len > 1 and not seg; --len) {
+                    if (auto it = fused.find(liated::join_spec(names, i, i + len)); it != fused.end()) {
+                        seg = &it->second;
+                    }
+                }
+                if (not seg) {
+                    seg = &find(spec, names[i]);
+                }
+
+                if (seg->in != cur) {
+                    liated::bad_spec(spec, "stage \"" + names[i] + "\" does not take the type before it");
+                }
+                cur = seg->out;
+                i += seg->stages;
+                ret.push_back(*seg);
+            }
+
+            if (cur != out) {
+                liated::bad_spec(spec, "the last stage does not make the output type");
+            }
+            return ret;
+        }
+    };
+
+    /**
+    * A pipeline from In to Out, assembled at runtime out of the stages of a fff::stage_registry.
+    * It returns std::nullopt for a value that some stage dropped.
+    * It keeps copies of its stages, so changing the registry afterwards does not change it.
+    * Every segment costs one indirect call, with no allocation between the stages.
+    */
+    template<typename In, typename Out>
+    class dynamic_pipeline {
+        std::vector<liated::DynSegment> segs;
+
+    public:
+        /**
+        * @throw std::invalid_argument if the spec is empty, names an unknown stage, or if the types do not match
+        */
+        dynamic_pipeline(const stage_registry &registry, std::string_view spec)
+            : segs(registry.assemble(spec, typeid(In), typeid(Out))) {}
+
+        auto operator()(In x) const -> std::optional<Out> {
+            std::optional<Out> ret;
+            segs.front().run(std::addressof(x), segs.data() + 1, segs.data() + segs.size(), std::addressof(ret));
+            return ret;
+        }
+
+        /**
+        * the number of segments, a fused segment counting once
+        */
+        [[nodiscard]] std::size_t size() const noexcept {
+            return segs.size();
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_DYNAMIC_PIPELINE_HPP
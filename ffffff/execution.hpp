@@ -0,0 +1,119 @@
+#ifndef UNDERSCORE_CPP_EXECUTION_HPP
+#define UNDERSCORE_CPP_EXECUTION_HPP
+
+#include <algorithm>
+#include <ranges>
+#include <type_traits>
+
+#include "executor.hpp"
+
+/*
+* fff::execution Reducible_TD
+*/
+namespace fff::execution {
+
+    struct sequenced_policy {};
+    struct unsequenced_policy {};
+    struct parallel_policy {};
+    struct parallel_unsequenced_policy {};
+
+    constexpr inline sequenced_policy seq;
+    constexpr inline unsequenced_policy unseq;
+    constexpr inline parallel_policy par;
+    constexpr inline parallel_unsequenced_policy par_unseq;
+
+    /**
+    * determines whether T is one of fff::execution::(policies)
+    */
+    template<typename T>
+    concept policy = std::is_same_v<std::remove_cvref_t<T>, sequenced_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, unsequenced_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, parallel_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, parallel_unsequenced_policy>;
+
+    /**
+    * determines whether T is a policy that allows splitting the work across threads
+    */
+    template<typename T>
+    concept parallel = std::is_same_v<std::remove_cvref_t<T>, parallel_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, parallel_unsequenced_policy>;
+
+    /**
+    * determines whether T is a policy that allows evaluating a block of elements before looking at any result,
+    * i.e. the calls of the function obj may run more than needed and in any order
+    */
+    template<typename T>
+    concept unsequenced = std::is_same_v<std::remove_cvref_t<T>, unsequenced_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, parallel_unsequenced_policy>;
+}
+
+namespace fff {
+
+    /**
+    * determines whether a parallel policy may split Cont into blocks across threads
+    */
+    template<typename Cont>
+    concept splittable = std::ranges::random_access_range<Cont> and std::ranges::sized_range<Cont>;
+}
+
+namespace fff::liated {
+
+    /**
+    * Cuts [0, n) into contiguous blocks, one block per worker.
+    * A block is never smaller than min_block, so small inputs stay on one thread.
+    */
+    struct BlockPlan {
+        std::size_t n;
+        std::size_t blocks;
+
+        constexpr BlockPlan(std::size_t n, std::size_t workers, std::size_t min_block) noexcept
+            : n(n), blocks(std::max<std::size_t>(1, std::min(workers, n / std::max<std::size_t>(1, min_block)))) {}
+
+        [[nodiscard]] constexpr std::size_t first(std::size_t b) const noexcept {
+            return n / blocks * b + std::min(b, n % blocks);
+        }
+
+        [[nodiscard]] constexpr std::size_t last(std::size_t b) const noexcept {
+            return first(b + 1);
+        }
+    };
+
+    inline std::size_t worker_count() noexcept {
+        return default_concurrency();
+    }
+
+    /**
+    * Runs body(b, first, last) for every block of the plan on fff::executor::global().
+    * Block 0 runs on the calling thread. The first exception thrown by any block is rethrown.
+    */
+    template<class Body>
+    void blocked_for(const BlockPlan &plan, Body &&body) {
+        if (plan.blocks == 1) {
+            body(std::size_t(0), std::size_t(0), plan.n);
+            return;
+        }
+
+        task_group group;
+        for (std::size_t b = 1; b < plan.blocks; ++b) {
+            group.spawn([&body, &plan, b] {
+                body(b, plan.first(b), plan.last(b));
+            });
+        }
+
+        body(std::size_t(0), plan.first(0), plan.last(0));
+        group.wait();
+    }
+
+    /**
+    * blocked_for over BlockPlan(n, worker_count(), min_block).
+    * @return the plan that was used, so callers can merge per-block results in order
+    */
+    template<class Body>
+    auto blocked_for(std::size_t n, Body &&body, std::size_t min_block = 4096) -> BlockPlan {
+        const BlockPlan plan(n, worker_count(), min_block);
+        blocked_for(plan, std::forward<Body>(body));
+        return plan;
+    }
+}
+
+#endif//UNDERSCORE_CPP_EXECUTION_HPP
@@ -0,0 +1,281 @@
+#ifndef UNDERSCORE_CPP_EXECUTOR_HPP
+#define UNDERSCORE_CPP_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "function.hpp"
+
+namespace fff::liated {
+
+    /**
+    * The number of threads the machine can run at once (at least 1),
+    * or the environment variable FFFFFF_THREADS if it holds a positive number (read once).
+    */
+    inline std::size_t default_concurrency() noexcept {
+        static const std::size_t n = [] {
+            if (const char *env = std::getenv("FFFFFF_THREADS")) {
+                char *end = nullptr;
+                const unsigned long v = std::strtoul(env, &end, 10);
+                if (end != env and *end == '\0' and v > 0) {
+                    return static_cast<std::size_t>(v);
+                }
+            }
+            return static_cast<std::size_t>(std::max(1u, std::thread::hardware_concurrency()));
+        }();
+        return n;
+    }
+
+    /**
+    * The size of a cache line, to keep the data of different threads from sharing one.
+    */
+    constexpr inline std::size_t cache_line = 64;
+}
+
+/*
+* fff::executor Reducible_TD
+*/
+namespace fff {
+
+    /**
+    * A work-stealing thread pool.\n
+    * Every worker owns a deque: it pushes and pops its own tasks at the back (LIFO, cache-friendly),
+    * and an idle worker steals from the front of the others' deques (FIFO, the oldest and largest tasks).
+    * @example fff::task_group g; g.spawn(f1); g.spawn(f2); g.wait();
+    */
+    class executor {
+    public:
+        using task = move_only_function<void()>;
+
+    private:
+        struct worker_queue {
+            std::mutex m;
+            std::deque<task> q;
+        };
+
+        std::vector<std::unique_ptr<worker_queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex sleep_m;
+        std::condition_variable sleep_cv;
+        std::atomic<std::size_t> queued = 0;
+        bool stopping = false;
+
+        std::atomic<std::size_t> next_queue = 0;
+
+        inline static thread_local executor *current = nullptr;
+        inline static thread_local std::size_t current_index = 0;
+
+        bool pop_local(std::size_t i, task &t) {
+            std::lock_guard lk(queues[i]->m);
+            if (queues[i]->q.empty()) {
+                return false;
+            }
+            t = std::move(queues[i]->q.back());
+            queues[i]->q.pop_back();
+            return true;
+        }
+
+        bool steal(std::size_t thief, task &t) {
+            for (std::size_t k = 1; k <= queues.size(); ++k) {
+                auto &victim = *queues[(thief + k) % queues.size()];
+
+                std::lock_guard lk(victim.m);
+                if (not victim.q.empty()) {
+                    t = std::move(victim.q.front());
+                    victim.q.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool take(task &t) {
+            if (current == this and pop_local(current_index, t)) {
+                return true;
+            }
+            return steal(current == this ? current_index : next_queue.load(std::memory_order_relaxed), t);
+        }
+
+        void worker_loop(std::size_t i) {
+            current = this;
+            current_index = i;
+
+            while (true) {
+                task t;
+                if (take(t)) {
+                    queued.fetch_sub(1, std::memory_order_relaxed);
+                    t();
+                    continue;
+                }
+
+                std::unique_lock lk(sleep_m);
+                sleep_cv.wait(lk, [this] { return stopping or queued.load() > 0; });
+                if (stopping and queued.load() == 0) {
+                    return;
+                }
+            }
+        }
+
+    public:
+        /**
+        * @param workers the number of worker threads (at least 1)
+        */
+        explicit executor(std::size_t workers = liated::default_concurrency()) {
+            workers = std::max<std::size_t>(1, workers);
+
+            queues.reserve(workers);
+            for (std::size_t i = 0; i < workers; ++i) {
+                queues.push_back(std::make_unique<worker_queue>());
+            }
+
+            threads.reserve(workers);
+            for (std::size_t i = 0; i < workers; ++i) {
+                threads.emplace_back([this, i] { worker_loop(i); });
+            }
+        }
+
+        executor(const executor &) = delete;
+        executor(executor &&) = delete;
+        executor &operator=(const executor &) = delete;
+        executor &operator=(executor &&) = delete;
+
+        /**
+        * Runs every task that is still queued, then joins the workers.
+        */
+        ~executor() {
+            {
+                std::lock_guard lk(sleep_m);
+                stopping = true;
+            }
+            sleep_cv.notify_all();
+
+            for (auto &th : threads) {
+                th.join();
+            }
+        }
+
+        /**
+        * Queues t. A worker queues onto its own deque; any other thread spreads tasks round-robin.
+        */
+        void submit(task t) {
+            {
+                std::lock_guard lk(sleep_m);
+                queued.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            const std::size_t i = current == this
+                ? current_index
+                : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            {
+                std::lock_guard lk(queues[i]->m);
+                queues[i]->q.push_back(std::move(t));
+            }
+
+            sleep_cv.notify_one();
+        }
+
+        /**
+        * Runs one queued task on the calling thread, if there is any.
+        * Threads that wait for their tasks call this so that they help instead of blocking.
+        * @return false if there was nothing to run
+        */
+        bool run_one() {
+            task t;
+            if (not take(t)) {
+                return false;
+            }
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            t();
+            return true;
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept {
+            return threads.size();
+        }
+
+        /**
+        * The default pool shared by every parallel feature of the library.
+        * It has one worker less than the machine's concurrency, since the waiting thread works too.
+        */
+        static executor &global() {
+            static executor instance(liated::default_concurrency() - 1);
+            return instance;
+        }
+    };
+
+    /**
+    * Fork-join on an executor : spawn() forks, wait() joins.\n
+    * wait() runs queued tasks while it waits, so nested task_groups never dead-lock.
+    * The first exception thrown by a task is rethrown by wait().
+    */
+    class task_group {
+        executor &ex;
+        std::atomic<std::size_t> pending = 0;
+
+        std::mutex error_m;
+        std::exception_ptr error;
+
+        void join() noexcept {
+            while (pending.load(std::memory_order_acquire) != 0) {
+                if (not ex.run_one()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+    public:
+        explicit task_group(executor &ex = executor::global()) noexcept : ex(ex) {}
+
+        task_group(const task_group &) = delete;
+        task_group &operator=(const task_group &) = delete;
+
+        /**
+        * Waits for the spawned tasks, but never throws.
+        */
+        ~task_group() {
+            join();
+        }
+
+        template<std::invocable F>
+        void spawn(F &&f) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            ex.submit([this, f = std::forward<F>(f)]() mutable {
+                try {
+                    std::invoke(f);
+                } catch (...) {
+                    std::lock_guard lk(error_m);
+                    if (not error) {
+                        error = std::current_exception();
+                    }
+                }
+                pending.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        void wait() {
+            join();
+
+            std::exception_ptr e;
+            {
+                std::lock_guard lk(error_m);
+                std::swap(e, error);
+            }
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_EXECUTOR_HPP
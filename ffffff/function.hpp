@@ -0,0 +1,239 @@
+#ifndef UNDERSCORE_CPP_FUNCTION_HPP
+#define UNDERSCORE_CPP_FUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+* fff::function Reducible_TD
+*
+* Type-erased handles for any fff callable (a Pipeline, an Overload, a bound operator, a lambda, ...).
+* A callable of at most N bytes lives inside the handle, so making, moving and copying the handle allocates nothing;
+* a larger one goes to the heap. There is no vtable : the handle keeps two plain function pointers,
+* one that calls the callable and one that moves, copies or destroys it.
+*/
+namespace fff {
+
+    namespace liated {
+
+        template<std::size_t N>
+        union function_storage {
+            void *heap;
+            alignas(void *) unsigned char buf[N < sizeof(void *) ? sizeof(void *) : N];
+        };
+
+        template<class Sig, std::size_t N, bool copyable>
+        class BasicFunction;
+
+        /**
+        * @tparam N the size of the inline buffer
+        * @tparam copyable false for a move-only handle, which also takes move-only callables
+        */
+        template<typename R, typename ...Args, std::size_t N, bool copyable>
+        class BasicFunction<R(Args...), N, copyable> {
+            template<class Sig, std::size_t M, bool c>
+            friend class BasicFunction;
+
+            using storage = function_storage<N>;
+
+            enum class op { move, copy, destroy };
+
+            mutable storage s;
+            R (*invoker)(storage &, Args &&...) = nullptr;
+            void (*manager)(op, storage &, storage *) = nullptr;
+
+            template<class F>
+            constexpr static bool fits = sizeof(F) <= sizeof(storage::buf)
+                and alignof(F) <= alignof(void *)
+                and std::is_nothrow_move_constructible_v<F>;
+
+            template<class F>
+            static F &target(storage &st) noexcept {
+                if constexpr (fits<F>) {
+                    return *std::launder(reinterpret_cast<F *>(st.buf));
+                } else {
+                    return *static_cast<F *>(st.heap);
+                }
+            }
+
+            template<class F>
+            static R invoke(storage &st, Args &&...args) {
+                if constexpr (std::is_void_v<R>) {
+                    std::invoke(target<F>(st), std::forward<Args>(args)...);
+                } else {
+                    return std::invoke(target<F>(st), std::forward<Args>(args)...);
+                }
+            }
+
+            template<class F>
+            static void manage(op o, storage &src, storage *dst) {
+                if constexpr (fits<F>) {
+                    switch (o) {
+                    case op::move:
+                        ::new (static_cast<void *>(dst->buf)) F(std::move(target<F>(src)));
+                        target<F>(src).~F();
+                        break;
+                    case op::copy:
+                        if constexpr (copyable) {
+                            ::new (static_cast<void *>(dst->buf)) F(target<F>(src));
+                        }
+                        break;
+                    case op::destroy:
+                        target<F>(src).~F();
+                        break;
+                    }
+                } else {
+                    switch (o) {
+                    case op::move:
+                        dst->heap = src.heap;
+                        break;
+                    case op::copy:
+                        if constexpr (copyable) {
+                            dst->heap = new F(target<F>(src));
+                        }
+                        break;
+                    case op::destroy:
+                        delete static_cast<F *>(src.heap);
+                        break;
+                    }
+                }
+            }
+
+            template<class F, typename ...Ts>
+            void emplace(Ts &&...ts) {
+                if constexpr (fits<F>) {
+                    ::new (static_cast<void *>(s.buf)) F(std::forward<Ts>(ts)...);
+                } else {
+                    s.heap = new F(std::forward<Ts>(ts)...);
+                }
+                invoker = &invoke<F>;
+                manager = &manage<F>;
+            }
+
+            void steal(BasicFunction &other) noexcept {
+                if (other.manager) {
+                    other.manager(op::move, other.s, &s);
+                    invoker = std::exchange(other.invoker, nullptr);
+                    manager = std::exchange(other.manager, nullptr);
+                }
+            }
+
+        public:
+            using result_type = R;
+
+            BasicFunction() noexcept = default;
+            BasicFunction(std::nullptr_t) noexcept {}
+
+            /**
+            * Wraps f; a null function pointer makes an empty handle.
+            */
+            template<class F>
+                requires (not std::is_same_v<std::remove_cvref_t<F>, BasicFunction>)
+                and std::is_invocable_r_v<R, std::decay_t<F> &, Args...>
+                and (not copyable or std::copy_constructible<std::decay_t<F>>)
+            BasicFunction(F &&f) {
+                if constexpr (std::is_pointer_v<std::remove_cvref_t<F>> or std::is_member_pointer_v<std::remove_cvref_t<F>>) {
+                    if (f == nullptr) {
+                        return;
+                    }
+                }
+                emplace<std::decay_t<F>>(std::forward<F>(f));
+            }
+
+            BasicFunction(const BasicFunction &other) requires copyable {
+                if (other.manager) {
+                    other.manager(op::copy, other.s, &s);
+                    invoker = other.invoker;
+                    manager = other.manager;
+                }
+            }
+
+            BasicFunction(BasicFunction &&other) noexcept {
+                steal(other);
+            }
+
+            BasicFunction &operator=(const BasicFunction &other) requires copyable {
+                if (this != &other) {
+                    BasicFunction copy(other);
+                    reset();
+                    steal(copy);
+                }
+                return *this;
+            }
+
+            BasicFunction &operator=(BasicFunction &&other) noexcept {
+                if (this != &other) {
+                    reset();
+                    steal(other);
+                }
+                return *this;
+            }
+
+            BasicFunction &operator=(std::nullptr_t) noexcept {
+                reset();
+                return *this;
+            }
+
+            ~BasicFunction() {
+                reset();
+            }
+
+            void reset() noexcept {
+                if (manager) {
+                    manager(op::destroy, s, nullptr);
+                    invoker = nullptr;
+                    manager = nullptr;
+                }
+            }
+
+            void swap(BasicFunction &other) noexcept {
+                BasicFunction tmp(std::move(other));
+                other.steal(*this);
+                steal(tmp);
+            }
+
+            /**
+            * Calls the callable, as an lvalue (as std::function does).
+            * @throw std::bad_function_call if the handle is empty
+            */
+            R operator()(Args ...args) const {
+                if (not invoker) {
+                    throw std::bad_function_call();
+                }
+                return invoker(s, std::forward<Args>(args)...);
+            }
+
+            explicit operator bool() const noexcept {
+                return invoker != nullptr;
+            }
+
+            friend bool operator==(const BasicFunction &f, std::nullptr_t) noexcept {
+                return not f;
+            }
+
+            /**
+            * determines whether F is kept inside the handle, without an allocation
+            */
+            template<class F>
+            constexpr static bool stored_inline = fits<std::decay_t<F>>;
+        };
+    }
+
+    /**
+    * A copyable handle to any callable of signature Sig, kept inline if it fits in N bytes.
+    * @example std::vector<fff::function<int(int)>> stages{fff::pipeline | f | g, fff::overload(h1, h2)};
+    */
+    template<class Sig, std::size_t N = 4 * sizeof(void *)>
+    using function = liated::BasicFunction<Sig, N, true>;
+
+    /**
+    * A move-only handle to any callable of signature Sig, move-only callables included, kept inline if it fits in N bytes.
+    */
+    template<class Sig, std::size_t N = 4 * sizeof(void *)>
+    using move_only_function = liated::BasicFunction<Sig, N, false>;
+}
+
+#endif//UNDERSCORE_CPP_FUNCTION_HPP
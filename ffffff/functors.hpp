@@ -3,13 +3,46 @@
 
 #include <functional>
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <ranges>
+#include <span>
 
 #include "tmf.hpp"
 #include "basic_ops.hpp"
+#include "containers.hpp"
+#include "execution.hpp"
+#include "simd.hpp"
 
 namespace fff {
 
+    /**
+    * determines whether fff::Map may write func(v) over each v of an rvalue Cont, and return Cont itself
+    */
+    template<class Cont, class FuncObj>
+    concept map_in_place = not std::is_reference_v<Cont> and not std::is_const_v<Cont>
+        and std::ranges::output_range<Cont, std::ranges::range_value_t<Cont>>
+        and std::is_same_v<std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<Cont>>,
+                           std::ranges::range_value_t<Cont>>;
+
+    /**
+    * determines whether fff::Filter may erase the rejected elements of an rvalue Cont, and return Cont itself.
+    * erase_if is found by ADL, so that the std::erase_if of a header included after this one is found too.
+    */
+    template<class Cont, class FuncObj>
+    concept filter_in_place = not std::is_reference_v<Cont> and not std::is_const_v<Cont>
+        and std::convertible_to<std::invoke_result_t<const FuncObj &, const std::ranges::range_value_t<Cont> &>, bool>
+        and requires (Cont &cont, bool (*pred)(const std::ranges::range_value_t<Cont> &)) { erase_if(cont, pred); };
+
+    namespace liated {
+
+        /**
+        * determines whether the elements of C can be overwritten through its iterators (NOT a set, an unordered_set, ...)
+        */
+        template<class C>
+        concept writable = requires (C &c, std::ranges::range_value_t<C> u) { *std::ranges::begin(c) = std::move(u); };
+    }
+
     /**
     * Making Result-Container function obj.
     * @param cont any std::(container) with type T
@@ -29,113 +62,410 @@ namespace fff {
             requires std::ranges::range<C<T>>
             and std::invocable<FuncObj, T>
             and std::is_default_constructible_v<std::invoke_result_t<FuncObj, T>>
-        constexpr auto operator()(const C<T> &cont, const FuncObj &func) const noexcept {
+            and std::constructible_from<C<std::invoke_result_t<FuncObj, T>>, std::size_t>
+            and liated::writable<C<std::invoke_result_t<FuncObj, T>>>
+        constexpr auto operator()(const C<T> &cont, const FuncObj &func) const {
             return C<std::invoke_result_t<FuncObj, T>>(cont.size());
         }
+
+        /**
+        * The same container of U, whose allocator is made of alloc (an allocator, or a std::pmr::memory_resource *)
+        */
+        template<class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and liated::rebindable<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>
+            and std::constructible_from<
+                liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>,
+                std::size_t,
+                typename liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>::allocator_type>
+            and liated::writable<liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>>
+        constexpr auto operator()(const Cont &cont, const FuncObj &, const A &alloc) const {
+            using R = liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>;
+            return R(cont.size(), typename R::allocator_type(alloc));
+        }
     };
 
+    /**
+    * Making an empty Result-Container, to be filled by appending.
+    * @return the same std::(container) as cont, of the return type of funcObj
+    */
     struct NewCont {
         template<class Cont, class FuncObj>
             requires std::ranges::range<Cont>
             and std::is_default_constructible_v<Cont>
-        constexpr auto operator()(const Cont &cont, const FuncObj &funcObj) const noexcept {
+            and std::is_same_v<std::invoke_result_t<FuncObj, typename Cont::value_type>, typename Cont::value_type>
+        constexpr auto operator()(const Cont &, const FuncObj &) const noexcept(std::is_nothrow_default_constructible_v<Cont>) {
             return Cont();
         }
-    };
 
-    struct MapExecution {
+        template<class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and (not std::is_same_v<std::invoke_result_t<FuncObj, typename Cont::value_type>, typename Cont::value_type>)
+            and liated::rebindable<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, typename Cont::allocator_type>
+        constexpr auto operator()(const Cont &, const FuncObj &) const {
+            return liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, typename Cont::allocator_type>();
+        }
+
         /**
-        * @todo consider if the return value of func is void
+        * The same container, whose allocator is made of alloc (an allocator, or a std::pmr::memory_resource *)
         */
-        template<class T_cont, class U_cont, class FuncObj>
-            requires std::ranges::range<T_cont>
-            and std::ranges::range<U_cont>
-            and std::is_same_v<typename std::invoke_result<FuncObj, typename T_cont::value_type>::type,
-                               typename U_cont::value_type>
-            constexpr auto &operator()(U_cont &u_cont, T_cont &t_cont, const FuncObj &func) const
-            noexcept(noexcept(func(t_cont[0])))
-        {
-            auto it_t = t_cont.begin();
-            auto it_u = u_cont.begin();
+        template<class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and liated::rebindable<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>
+        constexpr auto operator()(const Cont &, const FuncObj &, const A &alloc) const {
+            using R = liated::rebind_container_t<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>;
+            return R(typename R::allocator_type(alloc));
+        }
+    };
 
-            while (it_t != t_cont.end()) {
-                *it_u = std::invoke(func, *it_t);
-                ++it_t; ++it_u;
+    /**
+    * Underscore.js의 _.map(), but into memory that the caller already has.
+    * @param out one of\n
+    * std::span : fills it from the front, up to its size; returns the written part of it\n
+    * an output iterator : writes from it on; returns the iterator past the last written element\n
+    * a container : appends to it the cheapest way it can be, see the build strategies in containers.hpp; returns it
+    * @param cont any std::(container) with type T
+    * @param func any function obj with 1 param, say, T -> U
+    * @example auto got = fff::map_into(std::span(scratch), v, f);
+    */
+    struct MapInto {
+        template<typename U, std::size_t Extent, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::assignable_from<U &, std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>>>
+        constexpr auto operator()(std::span<U, Extent> out, const Cont &cont, const FuncObj &func) const -> std::span<U> {
+            if constexpr (std::ranges::sized_range<const Cont>) {
+                const std::size_t n = std::min<std::size_t>(out.size(), std::ranges::size(cont));
+                operator()(out.data(), std::views::take(cont, n), func);
+                return out.first(n);
+            } else {
+                std::size_t k = 0;
+                for (auto it = std::ranges::begin(cont); k < out.size() and it != std::ranges::end(cont); ++it, ++k) {
+                    out[k] = std::invoke(func, *it);
+                }
+                return out.first(k);
             }
+        }
 
-            return u_cont;
+        template<class OutIt, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and (not std::ranges::range<OutIt>)
+            and std::input_or_output_iterator<OutIt>
+            and requires (OutIt out, std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>> u) {
+                *out = std::move(u); }
+        constexpr auto operator()(OutIt out, const Cont &cont, const FuncObj &func) const -> OutIt {
+            if constexpr (simd::mappable_into<Cont, OutIt, FuncObj>) {
+                if (not std::is_constant_evaluated()) {
+                    const std::size_t n = std::ranges::size(cont);
+                    simd::map_kernel(std::ranges::data(cont), std::to_address(out), n, func);
+                    return out + static_cast<std::iter_difference_t<OutIt>>(n);
+                }
+            }
+
+            for (auto &&v : cont) {
+                *out = std::invoke(func, v);
+                ++out;
+            }
+            return out;
+        }
+
+        template<class Out, class Cont, class FuncObj>
+            requires std::ranges::range<Out> and (not std::ranges::view<Out>)
+            and std::ranges::range<Cont>
+            and (requires (Out &out, std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>> u) {
+                    out.push_back(std::move(u)); }
+                 or requires (Out &out, std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>> u) {
+                    out.insert(std::move(u)); })
+        constexpr auto operator()(Out &out, const Cont &cont, const FuncObj &func) const -> Out & {
+            if constexpr (std::ranges::contiguous_range<Out> and std::ranges::sized_range<const Cont>
+                          and requires (std::size_t n) { out.resize(n); }) {
+                const std::size_t old = std::ranges::size(out);
+                out.resize(old + std::ranges::size(cont));
+                operator()(std::ranges::begin(out) + old, cont, func);
+            } else if constexpr (liated::ordered_container<Out>) {
+                std::vector<std::ranges::range_value_t<Out>> buf;
+                if constexpr (std::ranges::sized_range<const Cont>) {
+                    buf.reserve(std::ranges::size(cont));
+                }
+
+                for (auto &&v : cont) {
+                    buf.push_back(std::invoke(func, v));
+                }
+                liated::append_all(out, std::move(buf));
+            } else {
+                if constexpr (std::ranges::sized_range<const Cont>) {
+                    liated::reserve_more(out, std::ranges::size(cont));
+                }
+
+                for (auto &&v : cont) {
+                    liated::append(out, std::invoke(func, v));
+                }
+            }
+            return out;
         }
     };
 
-    struct PushExecution {
-        template<class T_cont, class FuncObj>
-            requires std::ranges::range<T_cont>
-            and std::convertible_to<std::invoke_result_t<FuncObj, typename T_cont::value_type>, bool>
-            constexpr auto &operator()(T_cont &res_cont, T_cont &var_cont, const FuncObj &func) const
-            noexcept(noexcept(func(var_cont[0])))
-        {
-            for (const auto &t : var_cont) {
-                if (std::invoke(func, t)) {
-                    PushPolicy()(res_cont, t);
+    /**
+    * Underscore.js의 _.filter() (or _.reject() if not keep), but into memory that the caller already has.
+    * Takes every v with (func(v) == keep), in order.
+    * Over contiguous arithmetic elements the survivors are packed without a branch per element,
+    * with SIMD compares for the comparisons known to fff::simd.
+    * @param out the same as the out of fff::map_into; a span that gets full drops the remaining survivors\n
+    * a container is filled the cheapest way it can be, see the build strategies in containers.hpp
+    * @param cont any std::(container) with type T
+    * @param func any function obj with 1 param, say, T -> bool
+    */
+    template<bool keep>
+    struct SelectInto {
+        template<typename U, std::size_t Extent, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>>, bool>
+            and std::assignable_from<U &, std::ranges::range_reference_t<const Cont>>
+        constexpr auto operator()(std::span<U, Extent> out, const Cont &cont, const FuncObj &func) const -> std::span<U> {
+            std::size_t k = 0;
+
+            if constexpr (simd::compactable<Cont, FuncObj>) {
+                if (not std::is_constant_evaluated()) {
+                    simd::compact<keep>(std::ranges::data(cont), std::ranges::size(cont), func, [&out, &k](auto first, auto last) {
+                        const auto m = std::min<std::size_t>(static_cast<std::size_t>(last - first), out.size() - k);
+                        k = static_cast<std::size_t>(std::copy(first, first + m, out.data() + k) - out.data());
+                    });
+                    return out.first(k);
                 }
             }
 
-            return res_cont;
+            for (auto it = std::ranges::begin(cont); k < out.size() and it != std::ranges::end(cont); ++it) {
+                if (static_cast<bool>(std::invoke(func, *it)) == keep) {
+                    out[k++] = *it;
+                }
+            }
+            return out.first(k);
         }
 
-        struct PushPolicy {
-            /**
-            * If the container has push_back() method, apply it
-            */
-            template<template<class> class C, typename T>
-                requires backpushable<C>
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.push_back(val);
+        template<class OutIt, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and (not std::ranges::range<OutIt>)
+            and std::convertible_to<std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>>, bool>
+            and std::input_or_output_iterator<OutIt>
+            and requires (OutIt out, std::ranges::range_reference_t<const Cont> v) { *out = v; }
+        constexpr auto operator()(OutIt out, const Cont &cont, const FuncObj &func) const -> OutIt {
+            if constexpr (simd::compactable<Cont, FuncObj>) {
+                if (not std::is_constant_evaluated()) {
+                    simd::compact<keep>(std::ranges::data(cont), std::ranges::size(cont), func, [&out](auto first, auto last) {
+                        out = std::copy(first, last, out);
+                    });
+                    return out;
+                }
             }
 
-            /**
-            * If the container has no push_back() method and has insert() method,
-            * apply it
-            */
-            template<template<class> class C, typename T>
-                requires (not backpushable<C> and insertible<C>)
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.insert(val);
+            for (const auto &v : cont) {
+                if (static_cast<bool>(std::invoke(func, v)) == keep) {
+                    *out = v;
+                    ++out;
+                }
             }
-        };
+            return out;
+        }
+
+        template<class Out, class Cont, class FuncObj>
+            requires std::ranges::range<Out> and (not std::ranges::view<Out>)
+            and std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<const FuncObj &, std::ranges::range_reference_t<const Cont>>, bool>
+            and (requires (Out &out, const std::ranges::range_value_t<Cont> &v) { out.push_back(v); }
+                 or requires (Out &out, const std::ranges::range_value_t<Cont> &v) { out.insert(v); })
+        constexpr auto operator()(Out &out, const Cont &cont, const FuncObj &func) const -> Out & {
+            if constexpr (simd::compactable<Cont, FuncObj>
+                          and requires (const std::ranges::range_value_t<Cont> *p) { out.insert(out.end(), p, p); }) {
+                if (not std::is_constant_evaluated()) {
+                    simd::compact<keep>(std::ranges::data(cont), std::ranges::size(cont), func, [&out](auto first, auto last) {
+                        out.insert(out.end(), first, last);
+                    });
+                    return out;
+                }
+            }
+
+            if constexpr (liated::ordered_container<Out> and not liated::same_order<Cont, Out>) {
+                std::vector<std::ranges::range_value_t<Out>> buf;
+
+                for (const auto &v : cont) {
+                    if (static_cast<bool>(std::invoke(func, v)) == keep) {
+                        buf.push_back(v);
+                    }
+                }
+                liated::append_all(out, std::move(buf));
+            } else {
+                if constexpr (std::ranges::sized_range<const Cont> and requires { out.bucket_count(); }) {
+                    liated::reserve_more(out, std::ranges::size(cont));
+                }
+
+                for (const auto &v : cont) {
+                    if (static_cast<bool>(std::invoke(func, v)) == keep) {
+                        liated::append(out, v);
+                    }
+                }
+            }
+            return out;
+        }
     };
 
+    using FilterInto = SelectInto<true>;
+    using RejectInto = SelectInto<false>;
+
+    constexpr inline MapInto map_into;
+    constexpr inline FilterInto filter_into;
+    constexpr inline RejectInto reject_into;
+
     struct Each {
         template<class Cont, class FuncObj>
             requires std::ranges::range<Cont>
             and std::invocable<FuncObj, typename Cont::value_type &>
         constexpr void operator()(Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
+            noexcept(noexcept(std::invoke(func, *std::ranges::begin(cont))))
         {
             std::ranges::for_each(cont, func);
         }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+        void operator()(Policy &&, Cont &cont, const FuncObj &func) const {
+            if constexpr (execution::parallel<Policy> and splittable<Cont>) {
+                liated::blocked_for(std::ranges::size(cont), [&cont, &func](std::size_t, std::size_t first, std::size_t last) {
+                    auto it = std::ranges::begin(cont);
+                    std::for_each(it + first, it + last, std::cref(func));
+                });
+            } else {
+                operator()(cont, func);
+            }
+        }
     };
 
     struct Map {
         template<class Cont, class FuncObj>
             requires std::ranges::range<Cont>
             and std::invocable<FuncObj, typename Cont::value_type &>
-        constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
-        {
-            auto ret = PreallocCont()(cont, func);
-
-            {
-                auto it_t = cont.begin();
-                auto it_u = ret.begin();
+        constexpr auto operator()(const Cont &cont, const FuncObj &func) const {
+            return build(cont, func);
+        }
 
-                while (it_t != cont.end()) {
-                    *it_u = std::invoke(func, *it_t);
-                    ++it_t; ++it_u;
+        /**
+        * An rvalue container that func maps to its own value type is mapped in place, and returned.
+        * @example auto v2 = fff::map(std::move(v), f); // no new allocation
+        */
+        template<class Cont, class FuncObj>
+            requires map_in_place<Cont, FuncObj>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func) const -> Cont {
+            if constexpr (simd::mappable<Cont, Cont, FuncObj>) {
+                if (not std::is_constant_evaluated()) {
+                    simd::map_kernel(std::ranges::data(cont), std::ranges::data(cont), std::ranges::size(cont), func);
+                    return std::move(cont);
                 }
             }
 
-            return ret;
+            for (auto &&v : cont) {
+                v = std::invoke(func, v);
+            }
+            return std::move(cont);
+        }
+
+        /**
+        * The result allocates with alloc : an allocator of any value type, or a std::pmr::memory_resource *.
+        * @example auto got = fff::map(v, f, &arena); // std::pmr::vector\<U>
+        */
+        template<class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+            and liated::rebindable<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>
+        constexpr auto operator()(const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return build(cont, func, alloc);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func) const {
+            return run(policy, cont, func);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+            and liated::rebindable<Cont, std::invoke_result_t<FuncObj, typename Cont::value_type>, A>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return run(policy, cont, func, alloc);
+        }
+
+        /**
+        * Splits the work across threads if the policy is parallel and both containers are random-access.
+        * Falls back to the sequential loop otherwise (e.g. std::list, or std::vector\<bool> as a result).
+        * @param alloc none, or the allocator of the result
+        */
+        template<execution::policy Policy, class Cont, class FuncObj, class ...A>
+        static auto run(Policy &&, const Cont &cont, const FuncObj &func, const A &...alloc) {
+            using Ret = decltype(build(cont, func, alloc...));
+
+            if constexpr (execution::parallel<Policy> and splittable<const Cont> and splittable<Ret>
+                          and std::is_lvalue_reference_v<std::ranges::range_reference_t<Ret>>
+                          and requires { PreallocCont()(cont, func, alloc...); }) {
+                auto ret = PreallocCont()(cont, func, alloc...);
+
+                liated::blocked_for(std::ranges::size(cont), [&cont, &ret, &func](std::size_t, std::size_t first, std::size_t last) {
+                    if constexpr (simd::mappable<Cont, Ret, FuncObj>) {
+                        simd::map_kernel(std::ranges::data(cont) + first, std::ranges::data(ret) + first, last - first, func);
+                    } else {
+                        auto it_t = std::ranges::begin(cont);
+                        auto it_u = std::ranges::begin(ret);
+
+                        for (std::size_t i = first; i < last; ++i) {
+                            it_u[i] = std::invoke(func, it_t[i]);
+                        }
+                    }
+                });
+
+                return ret;
+            } else {
+                return build(cont, func, alloc...);
+            }
+        }
+
+        /**
+        * The sequential map. A container that can be made with its size (vector, deque, array, ...) is made so
+        * and written in place; any other container (set, unordered_set, ...) is made empty and filled by fff::map_into.
+        * @param alloc none, or the allocator of the result
+        */
+        template<class Cont, class FuncObj, class ...A>
+        constexpr static auto build(const Cont &cont, const FuncObj &func, const A &...alloc) {
+            if constexpr (requires { PreallocCont()(cont, func, alloc...); }) {
+                auto ret = PreallocCont()(cont, func, alloc...);
+                MapInto()(std::ranges::begin(ret), cont, func);
+                return ret;
+            } else {
+                auto ret = NewCont()(cont, func, alloc...);
+                MapInto()(ret, cont, func);
+                return ret;
+            }
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires map_in_place<Cont, FuncObj>
+        auto operator()(Policy &&, Cont &&cont, const FuncObj &func) const -> Cont {
+            if constexpr (execution::parallel<Policy> and splittable<Cont>
+                          and std::is_lvalue_reference_v<std::ranges::range_reference_t<Cont>>) {
+                liated::blocked_for(std::ranges::size(cont), [&cont, &func](std::size_t, std::size_t first, std::size_t last) {
+                    if constexpr (simd::mappable<Cont, Cont, FuncObj>) {
+                        simd::map_kernel(std::ranges::data(cont) + first, std::ranges::data(cont) + first, last - first, func);
+                    } else {
+                        auto it = std::ranges::begin(cont);
+
+                        for (std::size_t i = first; i < last; ++i) {
+                            it[i] = std::invoke(func, it[i]);
+                        }
+                    }
+                });
+
+                return std::move(cont);
+            } else {
+                return operator()(std::move(cont), func);
+            }
         }
     };
 
@@ -144,39 +474,257 @@ namespace fff {
             requires std::ranges::range<Cont>
             and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
         {
-            auto ret = NewCont()(cont, copy);
+            return select<true>(cont, func);
+        }
 
-            for (const auto &v : cont) {
-                if (std::invoke(func, v)) {
-                    PushPolicy()(ret, v);
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func) const {
+            return select<true>(policy, cont, func);
+        }
+
+        /**
+        * The result allocates with alloc : an allocator of any value type, or a std::pmr::memory_resource *.
+        * @example auto got = fff::filter(v, p, &arena); // std::pmr::vector\<T>
+        */
+        template<class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            and liated::rebindable<Cont, typename Cont::value_type, A>
+        constexpr auto operator()(const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return select<true>(cont, func, alloc);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            and liated::rebindable<Cont, typename Cont::value_type, A>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return select<true>(policy, cont, func, alloc);
+        }
+
+        /**
+        * An rvalue container is filtered in place : the rejected elements are erased, and the container is returned.
+        * @example auto v2 = fff::filter(std::move(v), p); // no new allocation
+        */
+        template<class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func) const -> Cont {
+            return select<true>(std::move(cont), func);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        auto operator()(Policy &&policy, Cont &&cont, const FuncObj &func) const -> Cont {
+            return select<true>(policy, std::move(cont), func);
+        }
+
+        /**
+        * Takes every v with (func(v) == keep), in order, by fff::SelectInto. Filter keeps, Reject does not.
+        * @param alloc none, or the allocator of the result
+        */
+        template<bool keep, class Cont, class FuncObj, class ...A>
+            requires std::ranges::range<Cont>
+        constexpr static auto select(const Cont &cont, const FuncObj &func, const A &...alloc) {
+            auto ret = NewCont()(cont, copy, alloc...);
+            SelectInto<keep>()(ret, cont, func);
+            return ret;
+        }
+
+        /**
+        * The in-place select : erases every v with (func(v) != keep) from cont.
+        * Over contiguous arithmetic elements the survivors are packed back into cont without a branch per element.
+        */
+        template<bool keep, class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        constexpr static auto select(Cont &&cont, const FuncObj &func) -> Cont {
+            if constexpr (simd::compactable<Cont, FuncObj>
+                          and requires (Cont &c) { c.erase(c.begin() + 1, c.end()); }) {
+                if (not std::is_constant_evaluated()) {
+                    auto out = std::ranges::data(cont);
+
+                    simd::compact<keep>(std::ranges::data(cont), std::ranges::size(cont), func, [&out](auto first, auto last) {
+                        out = std::copy(first, last, out);
+                    });
+                    cont.erase(cont.begin() + (out - std::ranges::data(cont)), cont.end());
+                    return std::move(cont);
                 }
             }
 
-            return ret;
+            erase_if(cont, [&func](const auto &v) {
+                return static_cast<bool>(std::invoke(func, v)) != keep;
+            });
+            return std::move(cont);
         }
 
-        struct PushPolicy {
-            /**
-            * If the container has push_back() method, apply it
-            */
-            template<template<class> class C, typename T>
-                requires backpushable<C>
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.push_back(val);
+        /**
+        * The parallel in-place select. Each block packs its survivors to the front of its own range,
+        * then the packed runs are moved down, in order, to close the gaps.
+        */
+        template<bool keep, execution::policy Policy, class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        static auto select(Policy &&, Cont &&cont, const FuncObj &func) -> Cont {
+            if constexpr (execution::parallel<Policy> and splittable<Cont>
+                          and std::ranges::output_range<Cont, std::ranges::range_value_t<Cont>>
+                          and requires (Cont &c) { c.erase(c.begin() + 1, c.end()); }) {
+                const std::size_t n = std::ranges::size(cont);
+                const liated::BlockPlan plan(n, liated::worker_count(), 4096);
+
+                std::vector<std::size_t> kept(plan.blocks, 0);
+
+                liated::blocked_for(plan, [&cont, &func, &kept](std::size_t b, std::size_t first, std::size_t last) {
+                    if constexpr (simd::compactable<Cont, FuncObj>) {
+                        auto out = std::ranges::data(cont) + first;
+
+                        simd::compact<keep>(std::ranges::data(cont) + first, last - first, func, [&out](auto f, auto l) {
+                            out = std::copy(f, l, out);
+                        });
+                        kept[b] = static_cast<std::size_t>(out - (std::ranges::data(cont) + first));
+                    } else {
+                        auto it = std::ranges::begin(cont);
+
+                        const auto end = std::remove_if(it + first, it + last, [&func](const auto &v) {
+                            return static_cast<bool>(std::invoke(func, v)) != keep;
+                        });
+                        kept[b] = static_cast<std::size_t>(end - (it + first));
+                    }
+                });
+
+                auto it = std::ranges::begin(cont);
+                auto out = it + kept[0];
+                for (std::size_t b = 1; b < plan.blocks; ++b) {
+                    const auto src = it + plan.first(b);
+                    // no gap yet, and moving a run onto itself would empty strings and vectors
+                    if (out == src) {
+                        out += kept[b];
+                    } else {
+                        out = std::move(src, src + kept[b], out);
+                    }
+                }
+                cont.erase(out, cont.end());
+
+                return std::move(cont);
+            } else {
+                return select<keep>(std::move(cont), func);
             }
+        }
+
+        /**
+        * The parallel select. The result keeps the input order.\n
+        * If the result is a resizable random-access container, Filter works in two phases:
+        * each block counts its matches, a prefix sum of the counts gives each block its offset,
+        * and each block scatters its matches into ONE exactly-sized result.
+        * A comparison known to fff::simd is cheap enough to evaluate twice, once in each phase;
+        * any other predicate is evaluated once and remembered.\n
+        * Otherwise each block filters into its own container, and the blocks are joined in order.
+        */
+        template<bool keep, execution::policy Policy, class Cont, class FuncObj, class ...A>
+        static auto select(Policy &&, const Cont &cont, const FuncObj &func, const A &...alloc) {
+            using Ret = decltype(NewCont()(cont, copy, alloc...));
+
+            if constexpr (execution::parallel<Policy> and std::ranges::contiguous_range<const Cont>
+                          and std::ranges::contiguous_range<Ret>
+                          and simd::compare_kernel_for<std::ranges::range_value_t<Cont>, FuncObj>
+                          and requires (Ret ret, std::size_t n) { ret.resize(n); }) {
+                const std::size_t n = std::ranges::size(cont);
+                const liated::BlockPlan plan(n, liated::worker_count(), 4096);
+
+                std::vector<std::size_t> offsets(plan.blocks + 1, 0);
+
+                liated::blocked_for(plan, [&cont, &func, &offsets](std::size_t b, std::size_t first, std::size_t last) {
+                    offsets[b + 1] = simd::count<keep>(std::ranges::data(cont) + first, last - first, func);
+                });
+
+                for (std::size_t b = 0; b < plan.blocks; ++b) {
+                    offsets[b + 1] += offsets[b];
+                }
+
+                auto ret = NewCont()(cont, copy, alloc...);
+                ret.resize(offsets[plan.blocks]);
+
+                liated::blocked_for(plan, [&cont, &ret, &func, &offsets](std::size_t b, std::size_t first, std::size_t last) {
+                    auto out = std::ranges::data(ret) + offsets[b];
+
+                    simd::compact<keep>(std::ranges::data(cont) + first, last - first, func, [&out](auto f, auto l) {
+                        out = std::copy(f, l, out);
+                    });
+                });
+
+                return ret;
+            } else if constexpr (execution::parallel<Policy> and splittable<const Cont> and splittable<Ret>
+                          and std::is_lvalue_reference_v<std::ranges::range_reference_t<Ret>>
+                          and requires (Ret ret, std::size_t n) { ret.resize(n); }) {
+                const std::size_t n = std::ranges::size(cont);
+                const liated::BlockPlan plan(n, liated::worker_count(), 4096);
+
+                std::vector<unsigned char> mask(n);
+                std::vector<std::size_t> offsets(plan.blocks + 1, 0);
+
+                liated::blocked_for(plan, [&cont, &func, &mask, &offsets](std::size_t b, std::size_t first, std::size_t last) {
+                    auto it = std::ranges::begin(cont);
+                    std::size_t cnt = 0;
+
+                    for (std::size_t i = first; i < last; ++i) {
+                        mask[i] = static_cast<bool>(std::invoke(func, it[i])) == keep;
+                        cnt += mask[i];
+                    }
+                    offsets[b + 1] = cnt;
+                });
+
+                for (std::size_t b = 0; b < plan.blocks; ++b) {
+                    offsets[b + 1] += offsets[b];
+                }
+
+                auto ret = NewCont()(cont, copy, alloc...);
+                ret.resize(offsets[plan.blocks]);
+
+                liated::blocked_for(plan, [&cont, &ret, &mask, &offsets](std::size_t b, std::size_t first, std::size_t last) {
+                    auto it_t = std::ranges::begin(cont);
+                    auto it_u = std::ranges::begin(ret) + offsets[b];
+
+                    for (std::size_t i = first; i < last; ++i) {
+                        if (mask[i]) {
+                            *it_u = it_t[i];
+                            ++it_u;
+                        }
+                    }
+                });
+
+                return ret;
+            } else if constexpr (execution::parallel<Policy> and splittable<const Cont>) {
+                const std::size_t n = std::ranges::size(cont);
+                const liated::BlockPlan plan(n, liated::worker_count(), 4096);
+
+                std::vector<Ret> parts;
+                parts.reserve(plan.blocks);
+                for (std::size_t b = 0; b < plan.blocks; ++b) {
+                    parts.push_back(NewCont()(cont, copy, alloc...));
+                }
+
+                liated::blocked_for(plan, [&cont, &func, &parts](std::size_t b, std::size_t first, std::size_t last) {
+                    auto it = std::ranges::begin(cont);
+
+                    for (std::size_t i = first; i < last; ++i) {
+                        const typename Cont::value_type &v = it[i];
+                        if (static_cast<bool>(std::invoke(func, v)) == keep) {
+                            liated::append(parts[b], v);
+                        }
+                    }
+                });
 
-            /**
-            * If the container has no push_back() method and has insert() method,
-            * apply it
-            */
-            template<template<class> class C, typename T>
-                requires (not backpushable<C> and insertible<C>)
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.insert(val);
+                auto ret = std::move(parts[0]);
+                for (std::size_t b = 1; b < parts.size(); ++b) {
+                    for (const typename Cont::value_type &v : parts[b]) {
+                        liated::append(ret, v);
+                    }
+                }
+                return ret;
+            } else {
+                return select<keep>(cont, func, alloc...);
             }
-        };
+        }
     };
 
     struct Reject {
@@ -184,12 +732,265 @@ namespace fff {
             requires std::ranges::range<Cont>
             and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
         {
-            return Filter()(cont, std::not_fn(func));
+            return Filter::select<false>(cont, func);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func) const {
+            return Filter::select<false>(policy, cont, func);
+        }
+
+        template<class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
+            and liated::rebindable<Cont, typename Cont::value_type, A>
+        constexpr auto operator()(const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return Filter::select<false>(cont, func, alloc);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj, class A>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
+            and liated::rebindable<Cont, typename Cont::value_type, A>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func, const A &alloc) const {
+            return Filter::select<false>(policy, cont, func, alloc);
+        }
+
+        template<class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func) const -> Cont {
+            return Filter::select<false>(std::move(cont), func);
+        }
+
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires filter_in_place<Cont, FuncObj>
+        auto operator()(Policy &&policy, Cont &&cont, const FuncObj &func) const -> Cont {
+            return Filter::select<false>(policy, std::move(cont), func);
+        }
+    };
+
+    namespace liated {
+
+        /**
+        * determines whether M maps keys to values, with node handles : std::map, std::unordered_map, ...
+        */
+        template<class M>
+        concept keyed = std::ranges::range<M> and requires (M &m) {
+            typename M::key_type;
+            typename M::mapped_type;
+            m.extract(m.begin());
+        };
+
+        /**
+        * func(value) if func takes 1 param, func(value, key) otherwise (as _.mapObject() does)
+        */
+        template<class FuncObj, typename V, typename K>
+            requires std::invocable<const FuncObj &, V &&> or std::invocable<const FuncObj &, V &&, const K &>
+        constexpr decltype(auto) call_mapped(const FuncObj &func, V &&v, const K &k) {
+            if constexpr (std::invocable<const FuncObj &, V &&>) {
+                return std::invoke(func, std::forward<V>(v));
+            } else {
+                return std::invoke(func, std::forward<V>(v), k);
+            }
+        }
+
+        /**
+        * what func makes of a value of M : a const one by default, or V (e.g. an rvalue, for a map that gives its values up)
+        */
+        template<class M, class FuncObj, typename V = const typename M::mapped_type &>
+        using mapped_result_t = std::remove_cvref_t<decltype(call_mapped(
+            std::declval<const FuncObj &>(), std::declval<V>(), std::declval<const typename M::key_type &>()))>;
+
+        /**
+        * An empty map like m, of U : the same comparator (or hasher and key_eq, and bucket count) and allocator.
+        */
+        template<typename U, class M>
+        auto new_mapped(const M &m) {
+            using R = rebind_mapped_t<M, U>;
+
+            if constexpr (requires { m.key_comp(); }) {
+                return R(m.key_comp(), typename R::allocator_type(m.get_allocator()));
+            } else {
+                return R(m.bucket_count(), m.hash_function(), m.key_eq(), typename R::allocator_type(m.get_allocator()));
+            }
+        }
+    }
+
+    /**
+    * Underscore.js의 _.mapObject()
+    * @param m std::map, std::unordered_map, ... of K -> V
+    * @param func any function obj, say, V -> U or (V, K) -> U
+    * @return the same kind of map of K -> U, with the same keys
+    */
+    struct MapValues {
+        template<class M, class FuncObj>
+            requires liated::keyed<M>
+            and requires { typename liated::mapped_result_t<M, FuncObj>; }
+        auto operator()(const M &m, const FuncObj &func) const {
+            auto ret = liated::new_mapped<liated::mapped_result_t<M, FuncObj>>(m);
+
+            for (const auto &[k, v] : m) {
+                ret.emplace_hint(ret.end(), k, liated::call_mapped(func, v, k));
+            }
+            return ret;
+        }
+
+        /**
+        * An rvalue map whose values func maps to their own type keeps its nodes : every value is rewritten in place.
+        */
+        template<class M, class FuncObj>
+            requires (not std::is_reference_v<M>) and (not std::is_const_v<M>)
+            and liated::keyed<M>
+            and std::is_same_v<liated::mapped_result_t<M, FuncObj, typename M::mapped_type &&>, typename M::mapped_type>
+        auto operator()(M &&m, const FuncObj &func) const -> M {
+            for (auto &[k, v] : m) {
+                v = liated::call_mapped(func, std::move(v), k);
+            }
+            return std::move(m);
+        }
+
+        /**
+        * An rvalue map whose values func maps to another type gives its nodes up one by one (extract),
+        * so that the keys and the old values are moved, not copied.
+        */
+        template<class M, class FuncObj>
+            requires (not std::is_reference_v<M>) and (not std::is_const_v<M>)
+            and liated::keyed<M>
+            and requires { typename liated::mapped_result_t<M, FuncObj, typename M::mapped_type &&>; }
+            and (not std::is_same_v<liated::mapped_result_t<M, FuncObj, typename M::mapped_type &&>, typename M::mapped_type>)
+        auto operator()(M &&m, const FuncObj &func) const {
+            auto ret = liated::new_mapped<liated::mapped_result_t<M, FuncObj, typename M::mapped_type &&>>(m);
+
+            while (not m.empty()) {
+                auto node = m.extract(m.begin());
+                auto u = liated::call_mapped(func, std::move(node.mapped()), std::as_const(node.key()));
+                ret.emplace_hint(ret.end(), std::move(node.key()), std::move(u));
+            }
+            return ret;
         }
     };
 
+    constexpr inline Each each;
+    constexpr inline Map map;
+    constexpr inline Filter filter;
+    constexpr inline Reject reject;
+    constexpr inline MapValues map_values;
+
+    namespace liated {
+
+        /**
+        * The width of a block of the block-wise scans : one bit of a 64-bit match mask per element.
+        */
+        constexpr inline std::size_t scan_block = 64;
+
+        /**
+        * The first i in [first, last) with (func(it[i]) == want), or last if there is none.
+        * @tparam unseq if true, every block is evaluated as a whole and tested ONCE, by its match mask
+        * @param stop polled once per block with the block's first index; true makes the scan give up (and return last)
+        */
+        template<bool want, bool unseq, class It, class FuncObj, class Stop>
+        auto find_first(It it, std::size_t first, std::size_t last, const FuncObj &func, Stop &&stop) -> std::size_t {
+            for (std::size_t i = first; i < last; i += scan_block) {
+                if (stop(i)) {
+                    return last;
+                }
+
+                const std::size_t end = std::min(last, i + scan_block);
+                if constexpr (unseq) {
+                    if (const auto m = simd::match_mask<want>(it + i, end - i, func); m != 0) {
+                        return i + static_cast<std::size_t>(std::countr_zero(m));
+                    }
+                } else {
+                    for (std::size_t j = i; j < end; ++j) {
+                        if (static_cast<bool>(std::invoke(func, it[j])) == want) {
+                            return j;
+                        }
+                    }
+                }
+            }
+            return last;
+        }
+    }
+
+    /**
+    * Underscore.js의 _.findIndex()
+    * @param cont any std::(container) with type T
+    * @param func any function obj with 1 param, say, T -> bool
+    * @return the index of the first element that func(element) is true, or -1
+    */
+    struct FindIndex {
+        template<class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t
+                                    <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
+        constexpr auto operator()(const Cont &cont, const FuncObj &func) const -> std::ptrdiff_t {
+            std::ptrdiff_t i = 0;
+            for (auto &v : cont) {
+                if (static_cast<bool>(std::invoke(func, v))) {
+                    return i;
+                }
+                ++i;
+            }
+            return -1;
+        }
+
+        /**
+        * With an unsequenced policy, func runs on a whole block of elements before the block is tested.
+        * With a parallel policy, a block skips the rest of its range once an earlier match is known.
+        */
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t
+                                    <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func) const -> std::ptrdiff_t {
+            if constexpr (splittable<const Cont>) {
+                const std::size_t i = find<true, true>(policy, cont, func);
+                return i == std::ranges::size(cont) ? -1 : static_cast<std::ptrdiff_t>(i);
+            } else {
+                return operator()(cont, func);
+            }
+        }
+
+        /**
+        * The machinery shared with fff::some, fff::every and fff::none.
+        * @tparam first_only false if ANY match will do; then the first match found stops every block
+        * @return an index i with (func(cont[i]) == want), the first one if first_only, or size(cont)
+        */
+        template<bool want, bool first_only, execution::policy Policy, class Cont, class FuncObj>
+            requires splittable<const Cont>
+        static auto find(Policy &&, const Cont &cont, const FuncObj &func) -> std::size_t {
+            constexpr bool unseq = execution::unsequenced<Policy>;
+
+            const std::size_t n = std::ranges::size(cont);
+            const auto it = std::ranges::begin(cont);
+
+            if constexpr (execution::parallel<Policy>) {
+                std::atomic<std::size_t> best = n;
+
+                liated::blocked_for(n, [it, n, &func, &best](std::size_t, std::size_t first, std::size_t last) {
+                    const std::size_t i = liated::find_first<want, unseq>(it, first, last, func, [n, &best](std::size_t at) {
+                        const std::size_t b = best.load(std::memory_order_relaxed);
+                        return first_only ? b <= at : b != n;
+                    });
+
+                    if (i != last) {
+                        std::size_t b = best.load(std::memory_order_relaxed);
+                        while (i < b and not best.compare_exchange_weak(b, i, std::memory_order_relaxed)) {}
+                    }
+                });
+
+                return best.load();
+            } else {
+                return liated::find_first<want, unseq>(it, 0, n, func, [](std::size_t) { return false; });
+            }
+        }
+    };
+
+    constexpr inline FindIndex find_index;
+
     template<bool func_ret, bool ret>
     struct LogicMake {
         template<class Cont, class FuncObj>
@@ -197,7 +998,7 @@ namespace fff {
             and std::convertible_to<std::invoke_result_t
                                     <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0]))) -> bool
+            noexcept(noexcept(std::invoke(func, *std::ranges::begin(cont)))) -> bool
         {
             for (auto &v : cont) {
                 if (static_cast<bool>(std::invoke(func, v)) == func_ret) {
@@ -206,6 +1007,23 @@ namespace fff {
             }
             return not ret;
         }
+
+        /**
+        * With an unsequenced policy, func runs on a whole block of elements before the block is tested.
+        * With a parallel policy, once any block finds the answer, every other block stops at its next block.
+        */
+        template<execution::policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t
+                                    <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
+        auto operator()(Policy &&policy, const Cont &cont, const FuncObj &func) const -> bool {
+            if constexpr (splittable<const Cont>) {
+                const bool found = FindIndex::find<func_ret, false>(policy, cont, func) != std::ranges::size(cont);
+                return found ? ret : not ret;
+            } else {
+                return operator()(cont, func);
+            }
+        }
     };
 
     using Some = LogicMake<true, true>;
@@ -28,10 +28,10 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...)))
                 -> typename TypeDeduction<F, Args...>::type
         {
-            return Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...);
+            return Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -44,10 +44,10 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...)))
                 -> typename TypeDeduction<F, Args...>::type
         {
-            return Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...);
+            return Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -73,9 +73,9 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...)))
         {
-            return Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...);
+            return Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -87,9 +87,9 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...)))
         {
-            return Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...);
+            return Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...);
         }
     };
 
@@ -115,10 +115,10 @@ namespace fff {
 
         template<std::invocable<T> F>
         constexpr auto lift(F &&f) const &
-            noexcept(noexcept(Derived::lift_impl(*static_cast<Derived*>(this), std::forward<F>(f))))
+            noexcept(noexcept(Derived::lift_impl(*static_cast<const Derived*>(this), std::forward<F>(f))))
                 -> C<std::invoke_result_t<F, T>>
         {
-            return Derived::lift_impl(*static_cast<Derived*>(this), std::forward<F>(f));
+            return Derived::lift_impl(*static_cast<const Derived*>(this), std::forward<F>(f));
         }
 
         template<std::invocable<T> F>
@@ -131,10 +131,10 @@ namespace fff {
 
         template<std::invocable<T> F>
         constexpr auto lift(F &&f) const &&
-            noexcept(noexcept(Derived::lift_impl(std::move(*static_cast<Derived*>(this)), std::forward<F>(f))))
+            noexcept(noexcept(Derived::lift_impl(std::move(*static_cast<const Derived*>(this)), std::forward<F>(f))))
                 -> C<std::invoke_result_t<F, T>>
         {
-            return Derived::lift_impl(std::move(*static_cast<Derived*>(this)), std::forward<F>(f));
+            return Derived::lift_impl(std::move(*static_cast<const Derived*>(this)), std::forward<F>(f));
         }
     };
 };
@@ -0,0 +1,259 @@
+#ifndef UNDERSCORE_CPP_MEMOIZE_HPP
+#define UNDERSCORE_CPP_MEMOIZE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "executor.hpp"
+#include "interfaces.hpp"
+#include "tmf.hpp"
+
+namespace fff::factory {
+    class Memoize;
+}
+
+/*
+* fff::memoize Reducible_TD
+*/
+namespace fff {
+
+    /**
+    * What a memoized function has done so far.
+    */
+    struct memo_stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        std::size_t size = 0;
+    };
+
+    namespace liated {
+
+        /**
+        * The call signature of F : a function, a function pointer, or a class with one non-template operator().
+        * @using result the return type
+        * @using key std::tuple of the decayed parameter types
+        */
+        template<class F>
+        struct call_signature {};
+
+        template<class F>
+            requires requires { &F::operator(); }
+        struct call_signature<F> : call_signature<decltype(&F::operator())> {};
+
+        template<typename R, typename ...A>
+        struct call_signature<R(A...)> {
+            using result = R;
+            using key = std::tuple<std::decay_t<A>...>;
+        };
+
+        template<typename R, typename ...A>
+        struct call_signature<R(A...) noexcept> : call_signature<R(A...)> {};
+
+        template<typename R, typename ...A>
+        struct call_signature<R(*)(A...)> : call_signature<R(A...)> {};
+
+        template<typename R, typename ...A>
+        struct call_signature<R(*)(A...) noexcept> : call_signature<R(A...)> {};
+
+        template<class C, typename R, typename ...A>
+        struct call_signature<R(C::*)(A...)> : call_signature<R(A...)> {};
+
+        template<class C, typename R, typename ...A>
+        struct call_signature<R(C::*)(A...) const> : call_signature<R(A...)> {};
+
+        template<class C, typename R, typename ...A>
+        struct call_signature<R(C::*)(A...) noexcept> : call_signature<R(A...)> {};
+
+        template<class C, typename R, typename ...A>
+        struct call_signature<R(C::*)(A...) const noexcept> : call_signature<R(A...)> {};
+
+        /**
+        * determines whether F has one call signature, so that its arguments can make a key
+        */
+        template<class F>
+        concept has_call_signature = requires { typename call_signature<F>::key; };
+
+        /**
+        * std::hash of a std::tuple, combining the std::hash of every element.
+        */
+        struct tuple_hash {
+            template<typename ...T>
+            std::size_t operator()(const std::tuple<T...> &t) const noexcept {
+                return std::apply([](const T &...x) {
+                    std::size_t h = 0;
+                    ((h ^= std::hash<T>()(x) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)), ...);
+                    return h;
+                }, t);
+            }
+        };
+
+        /**
+        * The cache of fff::memoize : a hash table cut into shards, each with its own lock, on its own cache lines.
+        * With a capacity, every shard keeps its entries in least-recently-used order and evicts the oldest one.
+        * f runs outside of any lock, so two threads that miss the same key at once may both compute it; the first result stays.
+        */
+        template<typename Key, typename R>
+        class MemoCache {
+            struct node {
+                R value;
+                typename std::list<const Key *>::iterator pos;
+            };
+
+            struct alignas(cache_line) shard {
+                std::mutex m;
+                std::unordered_map<Key, node, tuple_hash> index;
+                std::list<const Key *> lru; // the most recently used first, with a capacity only
+
+                std::atomic<std::size_t> hits = 0;
+                std::atomic<std::size_t> misses = 0;
+                std::atomic<std::size_t> evictions = 0;
+            };
+
+            std::size_t count;
+            std::size_t shard_capacity; // 0 for no capacity
+            std::unique_ptr<shard[]> shards;
+
+            shard &shard_of(const Key &key) noexcept {
+                const std::size_t h = tuple_hash()(key) * static_cast<std::size_t>(0x9e3779b97f4a7c15ull);
+                return shards[(h ^ (h >> (sizeof(std::size_t) * 4))) & (count - 1)];
+            }
+
+        public:
+            /**
+            * @param capacity the most entries to keep (about; it is split evenly among the shards), 0 for no limit
+            */
+            explicit MemoCache(std::size_t capacity) {
+                std::size_t n = std::bit_ceil(4 * default_concurrency());
+                if (capacity != 0) {
+                    n = std::min(n, std::bit_floor(std::max<std::size_t>(1, capacity / 16)));
+                }
+
+                count = n;
+                shard_capacity = capacity == 0 ? 0 : (capacity + n - 1) / n;
+                shards = std::make_unique<shard[]>(n);
+            }
+
+            template<class Fn>
+            R get(const Fn &f, Key &&key) {
+                shard &s = shard_of(key);
+                {
+                    std::lock_guard lk(s.m);
+                    if (auto it = s.index.find(key); it != s.index.end()) {
+                        if (shard_capacity != 0) {
+                            s.lru.splice(s.lru.begin(), s.lru, it->second.pos);
+                        }
+                        s.hits.fetch_add(1, std::memory_order_relaxed);
+                        return it->second.value;
+                    }
+                }
+
+                s.misses.fetch_add(1, std::memory_order_relaxed);
+                R value = std::apply(f, std::as_const(key));
+
+                std::lock_guard lk(s.m);
+                auto [it, fresh] = s.index.try_emplace(std::move(key), node{value, {}});
+                if (fresh and shard_capacity != 0) {
+                    s.lru.push_front(&it->first);
+                    it->second.pos = s.lru.begin();
+
+                    if (s.index.size() > shard_capacity) {
+                        const Key *oldest = s.lru.back();
+                        s.lru.pop_back();
+                        s.index.erase(*oldest);
+                        s.evictions.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                return value;
+            }
+
+            memo_stats stats() {
+                memo_stats ret;
+                for (std::size_t i = 0; i < count; ++i) {
+                    ret.hits += shards[i].hits.load(std::memory_order_relaxed);
+                    ret.misses += shards[i].misses.load(std::memory_order_relaxed);
+                    ret.evictions += shards[i].evictions.load(std::memory_order_relaxed);
+
+                    std::lock_guard lk(shards[i].m);
+                    ret.size += shards[i].index.size();
+                }
+                return ret;
+            }
+
+            void clear() {
+                for (std::size_t i = 0; i < count; ++i) {
+                    std::lock_guard lk(shards[i].m);
+                    shards[i].lru.clear();
+                    shards[i].index.clear();
+                }
+            }
+        };
+    }
+
+    /**
+    * Remembers f(args...) for every args it has seen, and returns it instead of calling f again, from any thread.\n
+    * The key is the std::tuple of the decayed parameters of f, hashed with std::hash.
+    * Copies of a Memoize_f share one cache.
+    * @example auto score = fff::memoize(expensive_score, 100'000); score(user, item); score.stats().hits;
+    */
+    template<class F>
+    class Memoize_f : public callable_i<F, Memoize_f<F>> {
+        friend callable_i<F, Memoize_f<F>>;
+        friend factory::Memoize;
+
+        using Key = typename liated::call_signature<F>::key;
+        using R = std::remove_cvref_t<typename liated::call_signature<F>::result>;
+
+        [[no_unique_address]] F f;
+        std::shared_ptr<liated::MemoCache<Key, R>> cache;
+
+        Memoize_f(const F &f, std::size_t capacity)
+            : f(f),             cache(std::make_shared<liated::MemoCache<Key, R>>(capacity)) {}
+        Memoize_f(F &&f, std::size_t capacity)
+            : f(std::move(f)),  cache(std::make_shared<liated::MemoCache<Key, R>>(capacity)) {}
+
+        template<similar<Memoize_f<F>> Self, typename ...Args>
+            requires std::constructible_from<Key, Args &&...>
+        static auto call_impl(Self &&self, Args &&...args) -> R {
+            return self.cache->get(self.f, Key(std::forward<Args>(args)...));
+        }
+
+    public:
+        [[nodiscard]] memo_stats stats() const {
+            return cache->stats();
+        }
+
+        void clear() const {
+            cache->clear();
+        }
+    };
+
+    namespace factory {
+        struct Memoize {
+            /**
+            * @param capacity the most results to keep, the least recently used going first; 0 (default) for no limit
+            */
+            template<class F>
+                requires liated::has_call_signature<std::decay_t<F>>
+                and (not std::is_void_v<typename liated::call_signature<std::decay_t<F>>::result>)
+            auto operator()(F &&f, std::size_t capacity = 0) const
+                -> Memoize_f<std::decay_t<F>>
+            {
+                return Memoize_f<std::decay_t<F>>(std::forward<F>(f), capacity);
+            }
+        };
+    }
+
+    constexpr inline factory::Memoize memoize;
+}
+
+#endif//UNDERSCORE_CPP_MEMOIZE_HPP
@@ -7,14 +7,24 @@
 
 #include "basic_ops.hpp"
 #include "bind.hpp"
+#include "containers.hpp"
+#include "dynamic_pipeline.hpp"
+#include "execution.hpp"
+#include "executor.hpp"
+#include "function.hpp"
 #include "functors.hpp"
 #include "interfaces.hpp"
+#include "memoize.hpp"
 #include "monads.hpp"
 #include "multiargs.hpp"
 #include "overload.hpp"
 #include "pipeline.hpp"
 #include "reducible.hpp"
+#include "scan.hpp"
+#include "simd.hpp"
+#include "stream.hpp"
 #include "tmf.hpp"
 #include "utils.hpp"
+#include "views.hpp"
 
 #endif //UNDERSCORE_CPP_PACKAGE_HPP
@@ -1,7 +1,13 @@
 #ifndef UNDERSCORE_CPP_PIPELINE_HPP
 #define UNDERSCORE_CPP_PIPELINE_HPP
 
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <ranges>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "multiargs.hpp"
 
@@ -10,12 +16,109 @@ namespace fff {
     template<class F, class ...Fp>
     struct Pipeline;
 
+    namespace liated {
+
+        struct PipelineStages;
+
+        /**
+        * The default batch of Pipeline::run_batched, so that a batch of a few stages' results stays in the L1 cache.
+        */
+        constexpr inline std::size_t default_batch = 1024;
+
+        /**
+        * Passes x on to the next stage, as a Pipeline does : a multi-return is applied, anything else invoked.
+        */
+        template<class F, typename X>
+        constexpr decltype(auto) feed(const F &f, X &&x) {
+            if constexpr (mr<std::remove_cvref_t<X>>) {
+                return std::apply(f, x.to_tuple());
+            } else {
+                return std::invoke(f, std::forward<X>(x));
+            }
+        }
+
+        template<class F, typename X>
+        using feed_result_t = std::remove_cvref_t<decltype(feed(std::declval<const F &>(), std::declval<X>()))>;
+
+        template<typename T, class Tuple>
+        struct batch_cons;
+
+        template<typename T, typename ...Ts>
+        struct batch_cons<T, std::tuple<Ts...>> {
+            using type = std::tuple<T, Ts...>;
+        };
+
+        /**
+        * buf[at + i] = f(first[i]) for every i < n, in one tight loop.
+        */
+        template<class F, class It, typename T>
+        constexpr void map_batch(const F &f, It first, std::size_t n, std::vector<T> &buf, std::size_t at) {
+            if constexpr (std::default_initializable<T> and std::is_move_assignable_v<T>) {
+                buf.resize(at + n);
+                for (std::size_t i = at; i < at + n; ++i, ++first) {
+                    buf[i] = feed(f, *first); // by index, not through data(), which std::vector<bool> does not have
+                }
+            } else {
+                buf.erase(buf.begin() + static_cast<std::ptrdiff_t>(at), buf.end());
+                for (std::size_t i = 0; i < n; ++i, ++first) {
+                    buf.push_back(feed(f, *first));
+                }
+            }
+        }
+
+        template<class Types, std::size_t ...I>
+        auto batch_buffers(std::index_sequence<I...>) -> std::tuple<std::vector<std::tuple_element_t<I, Types>>...>;
+
+        /**
+        * Cuts r into batches of batch_size and hands every batch to run(first, n, out, buffers...),
+        * which pushes it through the stages, one stage at a time.
+        * Types are the types that the stages make; there is one buffer for every one of them but the last (the result),
+        * kept from batch to batch.
+        */
+        template<class Types, class R, class Run>
+        auto run_batched(const R &r, std::size_t batch_size, const Run &run)
+            -> std::vector<std::tuple_element_t<std::tuple_size_v<Types> - 1, Types>>
+        {
+            std::vector<std::tuple_element_t<std::tuple_size_v<Types> - 1, Types>> ret;
+            if constexpr (std::ranges::sized_range<const R>) {
+                ret.reserve(std::ranges::size(r));
+            }
+
+            decltype(batch_buffers<Types>(std::make_index_sequence<std::tuple_size_v<Types> - 1>())) buffers;
+            batch_size = std::max<std::size_t>(1, batch_size);
+
+            auto first = std::ranges::begin(r);
+            const auto last = std::ranges::end(r);
+            while (first != last) {
+                auto next = std::ranges::next(first, static_cast<std::ranges::range_difference_t<const R>>(batch_size), last);
+                const auto n = static_cast<std::size_t>(std::ranges::distance(first, next));
+
+                std::apply([&](auto &...bufs) {
+                    run(first, n, ret, bufs...);
+                }, buffers);
+                first = next;
+            }
+            return ret;
+        }
+    }
+
     template<class F>
     class Pipeline<F> {
         friend class PipelineFactory;
+        friend struct liated::PipelineStages;
+        template<class, class ...>
+        friend struct Pipeline;
 
         [[no_unique_address]] F f;
 
+        template<class In>
+        using batch_types = std::tuple<liated::feed_result_t<F, In>>;
+
+        template<class It, typename Out>
+        constexpr void run_batch(It first, std::size_t n, std::vector<Out> &out) const {
+            liated::map_batch(f, first, n, out, out.size());
+        }
+
     public:
         constexpr explicit Pipeline(const F &f) noexcept : f(f) {}
         constexpr explicit Pipeline(F &&f) noexcept : f(std::move(f)) {}
@@ -47,6 +150,23 @@ namespace fff {
             return std::invoke(std::move(f), std::forward<Args>(args)...);
         }
 
+        /**
+        * Runs the pipeline on every element of r, a batch of batch_size elements at a time :
+        * every stage runs on the whole batch before the next one starts, so its code and data stay in the cache
+        * and its loop can vectorize. This pays off for stages with large code or data; stages of a few instructions
+        * run faster by the plain operator(), where the compiler fuses them.
+        * @return the results, in the order of r
+        * @example (fff::pipeline | decode | enrich | score).run_batched(records);
+        */
+        template<std::ranges::forward_range R>
+            requires std::invocable<const Pipeline &, std::ranges::range_reference_t<const R>>
+        auto run_batched(const R &r, std::size_t batch_size = liated::default_batch) const {
+            return liated::run_batched<batch_types<std::ranges::range_reference_t<const R>>>(r, batch_size,
+                [this](auto first, std::size_t n, auto &out, auto &...bufs) {
+                    run_batch(first, n, out, bufs...);
+                });
+        }
+
         template<class G>
         constexpr auto operator|(G &&g) const & noexcept -> Pipeline<F, std::decay_t<G>> {
             return Pipeline<F, std::decay_t<G>>{f, std::forward<G>(g)};
@@ -66,10 +186,28 @@ namespace fff {
     template<class F1, class ...Fp>
     class Pipeline {
         friend class PipelineFactory;
+        friend struct liated::PipelineStages;
+        template<class, class ...>
+        friend struct Pipeline;
 
         [[no_unique_address]] F1 f1;
         [[no_unique_address]] Pipeline<Fp...> f2;
 
+        /**
+        * the types that every stage makes from an In, the last one being the result
+        */
+        template<class In>
+        using batch_types = typename liated::batch_cons<
+            liated::feed_result_t<F1, In>,
+            typename Pipeline<Fp...>::template batch_types<liated::feed_result_t<F1, In>>
+        >::type;
+
+        template<class It, typename Out, typename Buf, typename ...Bufs>
+        constexpr void run_batch(It first, std::size_t n, std::vector<Out> &out, Buf &buf, Bufs &...bufs) const {
+            liated::map_batch(f1, first, n, buf, 0);
+            f2.run_batch(std::make_move_iterator(buf.begin()), n, out, bufs...);
+        }
+
     public:
         template<class U1, class U2>
         constexpr Pipeline(U1 &&f1, U2 &&f2) noexcept
@@ -129,6 +267,23 @@ namespace fff {
             return std::apply(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...).to_tuple());
         }
 
+        /**
+        * Runs the pipeline on every element of r, a batch of batch_size elements at a time :
+        * every stage runs on the whole batch before the next one starts, so its code and data stay in the cache
+        * and its loop can vectorize. This pays off for stages with large code or data; stages of a few instructions
+        * run faster by the plain operator(), where the compiler fuses them.
+        * @return the results, in the order of r
+        * @example (fff::pipeline | decode | enrich | score).run_batched(records);
+        */
+        template<std::ranges::forward_range R>
+            requires std::invocable<const Pipeline &, std::ranges::range_reference_t<const R>>
+        auto run_batched(const R &r, std::size_t batch_size = liated::default_batch) const {
+            return liated::run_batched<batch_types<std::ranges::range_reference_t<const R>>>(r, batch_size,
+                [this](auto first, std::size_t n, auto &out, auto &...bufs) {
+                    run_batch(first, n, out, bufs...);
+                });
+        }
+
         template<class G>
         constexpr auto operator|(G &&g) const & noexcept
             -> Pipeline<F1, Fp..., std::decay_t<G>>
@@ -174,6 +329,26 @@ namespace fff {
             return Pipeline<std::decay_t<F>>{std::forward<F>(f)};
         }
     };
+
+    constexpr inline PipelineFactory pipeline;
+
+    namespace liated {
+
+        /**
+        * The stages of a Pipeline, copied into a std::tuple. A Pipeline nested as a stage stays one stage.
+        */
+        struct PipelineStages {
+            template<class F>
+            static auto of(const Pipeline<F> &p) -> std::tuple<F> {
+                return std::tuple<F>(p.f);
+            }
+
+            template<class F1, class ...Fp>
+            static auto of(const Pipeline<F1, Fp...> &p) -> std::tuple<F1, Fp...> {
+                return std::tuple_cat(std::tuple<F1>(p.f1), of(p.f2));
+            }
+        };
+    }
 }
 
 
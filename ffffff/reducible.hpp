@@ -1,9 +1,15 @@
 #ifndef UNDERSCORE_CPP_REDUCIBLE_HPP
 #define UNDERSCORE_CPP_REDUCIBLE_HPP
 
+#include "execution.hpp"
 #include "interfaces.hpp"
+#include "simd.hpp"
 #include "tmf.hpp"
 #include <functional>
+#include <optional>
+#include <ranges>
+#include <tuple>
+#include <vector>
 
 namespace fff::factory {
     class Reducible;
@@ -11,29 +17,128 @@ namespace fff::factory {
 
 namespace fff {
 
+    /**
+    * is_associative\<Op> tells whether op(op(a, b), c) == op(a, op(b, c)),
+    * so that a range may be reduced in any grouping (but still in order; commutativity is NOT assumed).
+    * The floating-point + and * count as associative, as in std::reduce : the result may differ in the last bits.
+    * Specialize it for your own operations.
+    */
+    template<class Op>
+    struct is_associative : std::false_type {};
+
+    template<typename T> struct is_associative<std::plus<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::multiplies<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_and<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_or<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_xor<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::logical_and<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::logical_or<T>> : std::true_type {};
+
+    template<class Op>
+    constexpr inline bool is_associative_v = is_associative<std::remove_cvref_t<Op>>::value;
+
     namespace liated {
-        template<typename F, typename Arg_1, typename Arg_2, typename ...Args>
-        struct Reducible_TD;
 
-        template<typename F, typename Arg_1, typename Arg_2>
-        struct Reducible_TD<F, Arg_1, Arg_2> {
-            using type = std::invoke_result_t<F, Arg_1, Arg_2>;
+        /**
+        * The left fold as a fold expression : (LeftFold{f, a} << ... << args).value == f(f(f(a, b), c), ...)
+        * The instantiation depth does NOT grow with the number of arguments.
+        * @tparam T the type of the value so far; a reference to the first argument, then the results of f
+        */
+        template<class Fn, typename T>
+        struct LeftFold {
+            Fn &f;
+            T value;
 
-            constexpr static bool nothrow = std::is_nothrow_invocable_v<F, Arg_1, Arg_2>;
+            template<typename U>
+            constexpr auto operator<<(U &&u) && noexcept(std::is_nothrow_invocable_v<Fn &, T, U>)
+                -> LeftFold<Fn, std::invoke_result_t<Fn &, T, U>>
+            {
+                return {f, std::invoke(f, std::forward<T>(value), std::forward<U>(u))};
+            }
         };
 
-        template<typename F, typename Arg_1, typename Arg_2, typename ...Args>
-        struct Reducible_TD {
-            using type = typename Reducible_TD<
-                F, std::invoke_result_t<F, Arg_1, Arg_2>, Args...
-                >::type;
+        /**
+        * The balanced fold of the N arguments of args from Lo on : f(fold of the first half, fold of the second half).
+        * The instantiation depth is O(log N).
+        * @param args a std::tuple of forwarding references; each argument is forwarded exactly once
+        */
+        template<std::size_t Lo, std::size_t N>
+        struct BalancedFold {
+            constexpr static std::size_t half = N / 2;
+
+            template<class Fn, class Tuple>
+            constexpr static auto call(Fn &f, Tuple &&args)
+                noexcept(noexcept(std::invoke(f, BalancedFold<Lo, half>::call(f, std::move(args)),
+                                                 BalancedFold<Lo + half, N - half>::call(f, std::move(args)))))
+                -> decltype(std::invoke(f, BalancedFold<Lo, half>::call(f, std::move(args)),
+                                           BalancedFold<Lo + half, N - half>::call(f, std::move(args))))
+            {
+                return std::invoke(f, BalancedFold<Lo, half>::call(f, std::move(args)),
+                                      BalancedFold<Lo + half, N - half>::call(f, std::move(args)));
+            }
+
+            /**
+            * The same fold, but the first half runs as a task of fff::executor::global() while this thread does the second.
+            * Halves of less than 2 arguments are not worth a task, and are folded in place.
+            */
+            template<class Fn, class Tuple>
+            static auto call_parallel(Fn &f, Tuple &&args) -> decltype(call(f, std::move(args))) {
+                if constexpr (half < 2) {
+                    return call(f, std::move(args));
+                } else {
+                    std::optional<std::remove_cvref_t<decltype(BalancedFold<Lo, half>::call(f, std::move(args)))>> first;
+
+                    task_group group;
+                    group.spawn([&f, &args, &first] {
+                        first.emplace(BalancedFold<Lo, half>::call_parallel(f, std::move(args)));
+                    });
+                    auto second = BalancedFold<Lo + half, N - half>::call_parallel(f, std::move(args));
+                    group.wait();
+
+                    return std::invoke(f, std::move(*first), std::move(second));
+                }
+            }
         };
+
+        template<std::size_t Lo>
+        struct BalancedFold<Lo, 1> {
+            template<class Fn, class Tuple>
+            constexpr static auto call(Fn &, Tuple &&args) noexcept -> decltype(std::get<Lo>(std::move(args))) {
+                return std::get<Lo>(std::move(args));
+            }
+
+            template<class Fn, class Tuple>
+            static auto call_parallel(Fn &f, Tuple &&args) noexcept -> decltype(std::get<Lo>(std::move(args))) {
+                return call(f, std::move(args));
+            }
+        };
+
+        /**
+        * determines whether f(args...) may be folded as a balanced tree and give what the left fold gives :
+        * Fn is associative, every argument has the same type (so the tree never calls f on a pair that the left fold
+        * would not have met, e.g. two string literals), and every call of the tree is well-formed.
+        */
+        template<class Fn, typename ...Args>
+        concept balanceable = is_associative_v<Fn> and (sizeof...(Args) >= 2)
+            and (std::is_same_v<std::remove_cvref_t<Args>, std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>> and ...)
+            and requires (Fn &f, Args &&...args) {
+                BalancedFold<0, sizeof...(Args)>::call(f, std::forward_as_tuple(std::forward<Args>(args)...));
+            };
     }
 
-    template<typename F>
-    class Reducible_f : public callable_i<F, Reducible_f<F>, liated::Reducible_TD> {
+    /**
+    * f(a, b, c, d, ...) for any binary f.\n
+    * An associative f (see fff::is_associative) over arguments of one type is folded as a balanced tree, f(f(a, b), f(c, d));
+    * anything else is folded from the left, f(f(f(a, b), c), d). Either way every argument is forwarded, never copied.
+    * @tparam Policy fff::execution::par (or par_unseq) folds the two halves of every balanced fold concurrently,
+    * which pays off for expensive operations (string or big-integer concatenation, ...).
+    * It takes an associative f only; specialize fff::is_associative for your own.
+    * @example auto cat = fff::reducible(fff::execution::par, std::plus<>()); cat(s1, s2, s3, s4);
+    */
+    template<typename F, class Policy = execution::sequenced_policy>
+    class Reducible_f : public callable_i<F, Reducible_f<F, Policy>> {
 
-        friend callable_i<F, Reducible_f<F>, liated::Reducible_TD>;
+        friend callable_i<F, Reducible_f<F, Policy>>;
         friend factory::Reducible;
 
         [[no_unique_address]] F f;
@@ -41,31 +146,38 @@ namespace fff {
         constexpr explicit Reducible_f(const F &f) noexcept : f(f) {}
         constexpr explicit Reducible_f(F &&f) noexcept : f(std::move(f)) {}
 
-        template<typename Self, typename T1, typename T2>
-        constexpr static auto call_impl(Self &&self, T1 &&t1, T2 &&t2)
-            noexcept(std::is_nothrow_invocable_v<F, T1, T2>)
-                -> std::invoke_result_t<F, T1, T2>
-        {
-            return std::invoke(self.f,
-                               std::forward<T1>(t1),
-                               std::forward<T2>(t2));
-        }
-
-        // @todo Determine noexcept condition
+        template<typename Self, typename ...Args>
+        constexpr static bool balanced = liated::balanceable<std::remove_reference_t<decltype((std::declval<Self>().f))>, Args...>;
 
         template<typename Self, typename T1, typename T2, typename ...Args>
+            requires (not balanced<Self, T1, T2, Args...>)
         constexpr static auto call_impl(Self &&self, T1 &&t1, T2 &&t2, Args &&...args)
-            noexcept
-                -> typename liated::Reducible_TD<F, T1, T2, Args...>::type
+            noexcept(noexcept(((liated::LeftFold<std::remove_reference_t<decltype((self.f))>, T1 &&>{self.f, std::forward<T1>(t1)}
+                                << std::forward<T2>(t2)) << ... << std::forward<Args>(args)).value))
+        {
+            return ((liated::LeftFold<std::remove_reference_t<decltype((self.f))>, T1 &&>{self.f, std::forward<T1>(t1)}
+                     << std::forward<T2>(t2)) << ... << std::forward<Args>(args)).value;
+        }
+
+        template<typename Self, typename ...Args>
+            requires balanced<Self, Args...> and (not execution::parallel<Policy>)
+        constexpr static auto call_impl(Self &&self, Args &&...args)
+            noexcept(noexcept(liated::BalancedFold<0, sizeof...(Args)>::call(self.f, std::forward_as_tuple(std::forward<Args>(args)...))))
         {
-            return call_impl(self,
-                             std::invoke(self.f,
-                                         std::forward<T1>(t1),
-                                         std::forward<T2>(t2)),
-                             args...);
+            return liated::BalancedFold<0, sizeof...(Args)>::call(self.f, std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        template<typename Self, typename ...Args>
+            requires balanced<Self, Args...> and execution::parallel<Policy>
+        static auto call_impl(Self &&self, Args &&...args) {
+            return liated::BalancedFold<0, sizeof...(Args)>::call_parallel(self.f, std::forward_as_tuple(std::forward<Args>(args)...));
         }
     };
 
+    template<typename F, class Policy>
+    struct is_associative<Reducible_f<F, Policy>>
+        : is_associative<F> {};
+
     namespace factory {
         struct Reducible {
             template<typename F>
@@ -74,10 +186,222 @@ namespace fff {
             {
                 return Reducible_f<std::decay_t<F>>(std::forward<F>(f));
             }
+
+            template<execution::policy Policy, typename F>
+                requires (not execution::parallel<Policy> or is_associative_v<F>)
+            constexpr auto operator()(Policy &&, F &&f) const noexcept
+                -> Reducible_f<std::decay_t<F>, std::remove_cvref_t<Policy>>
+            {
+                return Reducible_f<std::decay_t<F>, std::remove_cvref_t<Policy>>(std::forward<F>(f));
+            }
         };
     }
 
     constexpr inline factory::Reducible reducible;
+
+    namespace liated {
+        /**
+        * determines whether Op adds two Ts as T's own + does : std::plus<> or std::plus\<T>.
+        * std::plus\<U> of another U converts every operand to U first, so it is a different op.
+        */
+        template<class Op, typename T>
+        struct is_plus : std::false_type {};
+
+        template<typename T> struct is_plus<std::plus<>, T> : std::true_type {};
+        template<typename T> struct is_plus<std::plus<T>, T> : std::true_type {};
+
+        template<typename F, class Policy, typename T>
+        struct is_plus<Reducible_f<F, Policy>, T> : is_plus<F, T> {};
+
+        /**
+        * determines whether reducing R by Op into T is a sum that fff::simd::sum can do
+        */
+        template<class R, class Op, typename T>
+        concept simd_sum = is_plus<std::remove_cvref_t<Op>, T>::value
+            and std::ranges::contiguous_range<const R>
+            and std::is_same_v<std::ranges::range_value_t<R>, T>
+            and simd::liated::summable<T>;
+
+        /**
+        * determines whether reducing R by Op into T is a floating-point sum that fff::simd::compensated_sum can do
+        */
+        template<class R, class Op, typename T>
+        concept compensable = is_plus<std::remove_cvref_t<Op>, T>::value
+            and std::floating_point<T>
+            and std::ranges::contiguous_range<const R>
+            and std::is_same_v<std::ranges::range_value_t<R>, T>;
+
+        /**
+        * op(...op(r[first], r[first + 1])..., r[last - 1]) of a non-empty block of a random-access range.
+        */
+        template<typename T, class R, class Op>
+        T fold_block(const R &r, const Op &op, std::size_t first, std::size_t last) {
+            if constexpr (simd_sum<R, Op, T>) {
+                return simd::sum(std::ranges::data(r) + first, last - first);
+            } else {
+                auto it = std::ranges::begin(r);
+
+                T acc = it[first];
+                for (std::size_t i = first + 1; i < last; ++i) {
+                    acc = std::invoke(op, std::move(acc), it[i]);
+                }
+                return acc;
+            }
+        }
+
+        /**
+        * Combines parts[0], parts[1], ... pairwise by index, as a tree whose shape depends only on parts.size().
+        * The result is left in parts[0].
+        */
+        template<typename X, class Combine>
+        void fold_pairwise(std::vector<std::optional<X>> &parts, const Combine &combine) {
+            for (std::size_t step = 1; step < parts.size(); step *= 2) {
+                for (std::size_t b = 0; b + step < parts.size(); b += 2 * step) {
+                    parts[b] = combine(std::move(*parts[b]), std::move(*parts[b + step]));
+                }
+            }
+        }
+
+        /**
+        * The number of elements of a leaf of a reproducible reduce. It must never depend on the machine.
+        */
+        constexpr inline std::size_t reproducible_leaf = 4096;
+    }
+
+    /**
+    * Asks fff::reduce for a result that depends only on the input, never on the policy or on the number of workers.
+    * @tparam compensated true if a floating-point sum also keeps the rounding error of every addition
+    */
+    template<bool compensated = false>
+    struct Reproducible {};
+
+    constexpr inline Reproducible<> reproducible;
+    constexpr inline Reproducible<true> reproducible_compensated;
+
+    /**
+    * fold of a range : op(...op(op(init, r[0]), r[1])..., r[n - 1]).
+    * A sum of numbers over a contiguous range runs on independent accumulators, in SIMD registers where there is a kernel
+    * (see fff::simd::sum).
+    * @example auto total = fff::reduce(v, std::plus<>(), 0);
+    * @example auto total = fff::reduce(fff::execution::par, v, std::plus<>(), 0.0);
+    */
+    struct Reduce {
+        template<class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        constexpr auto operator()(const R &r, const Op &op, T init) const -> T {
+            if constexpr (liated::simd_sum<R, Op, T>) {
+                if (not std::is_constant_evaluated()) {
+                    return std::invoke(op, std::move(init), simd::sum(std::ranges::data(r), std::ranges::size(r)));
+                }
+            }
+
+            for (auto &&x : r) {
+                init = std::invoke(op, std::move(init), std::forward<decltype(x)>(x));
+            }
+            return init;
+        }
+
+        /**
+        * With a parallel policy, a random-access range and an associative op (see fff::is_associative),
+        * every block is reduced on its own, and the per-block partials are combined pairwise, as a tree.
+        * Otherwise the same as the sequential reduce.
+        * There is one block per worker, so a floating-point result may change with the number of workers;
+        * see fff::reproducible.
+        */
+        template<execution::policy Policy, class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(Policy &&, const R &r, const Op &op, T init) const -> T {
+            if constexpr (execution::parallel<Policy> and splittable<const R> and is_associative_v<Op>
+                          and std::convertible_to<std::invoke_result_t<const Op &, T, T>, T>) {
+                const liated::BlockPlan plan(std::ranges::size(r), liated::worker_count(), 4096);
+                if (plan.blocks == 1) {
+                    return operator()(r, op, std::move(init));
+                }
+
+                std::vector<std::optional<T>> partials(plan.blocks);
+
+                liated::blocked_for(plan, [&r, &op, &partials](std::size_t b, std::size_t first, std::size_t last) {
+                    partials[b] = liated::fold_block<T>(r, op, first, last);
+                });
+
+                liated::fold_pairwise(partials, [&op](T &&a, T &&b) {
+                    return std::invoke(op, std::move(a), std::move(b));
+                });
+                return std::invoke(op, std::move(init), std::move(*partials[0]));
+            } else {
+                return operator()(r, op, std::move(init));
+            }
+        }
+
+        /**
+        * The reproducible reduce, for an associative op (see fff::is_associative) :
+        * r is cut into leaves of a fixed size, every leaf is reduced on its own
+        * (the leaves are spread across the workers with a parallel policy),
+        * and the leaf partials are combined pairwise by index, as a tree whose shape depends only on the size of r.
+        * So the result is the same for seq, par and any number of workers, bit for bit;
+        * a sum is also the same on every target, as fff::simd::sum adds in an order that does not depend on the instruction set.\n
+        * fff::reproducible_compensated, for a floating-point sum, also adds up the rounding error of every addition (2Sum)
+        * and adds it back at the end, which keeps the result close to the exact sum.
+        * @example auto total = fff::reduce(fff::execution::par, v, std::plus<>(), 0.0, fff::reproducible);
+        */
+        template<execution::policy Policy, class R, class Op, typename T, bool compensated>
+            requires splittable<const R>
+            and is_associative_v<Op>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, T>, T>
+            and (not compensated or liated::compensable<R, Op, T>)
+        auto operator()(Policy &&, const R &r, const Op &op, T init, Reproducible<compensated>) const -> T {
+            using Part = std::conditional_t<compensated, simd::compensated<T>, T>;
+
+            const std::size_t n = std::ranges::size(r);
+            if (n == 0) {
+                return init;
+            }
+
+            const std::size_t leaves = (n + liated::reproducible_leaf - 1) / liated::reproducible_leaf;
+            std::vector<std::optional<Part>> partials(leaves);
+
+            const liated::BlockPlan plan(leaves, execution::parallel<Policy> ? liated::worker_count() : 1, 1);
+            liated::blocked_for(plan, [&r, &op, &partials, n](std::size_t, std::size_t first, std::size_t last) {
+                for (std::size_t leaf = first; leaf < last; ++leaf) {
+                    const std::size_t from = leaf * liated::reproducible_leaf;
+                    const std::size_t to = std::min(n, from + liated::reproducible_leaf);
+
+                    if constexpr (compensated) {
+                        partials[leaf] = simd::compensated_sum(std::ranges::data(r) + from, to - from);
+                    } else {
+                        partials[leaf] = liated::fold_block<T>(r, op, from, to);
+                    }
+                }
+            });
+
+            liated::fold_pairwise(partials, [&op](Part &&a, Part &&b) -> Part {
+                if constexpr (compensated) {
+                    return a += b;
+                } else {
+                    return std::invoke(op, std::move(a), std::move(b));
+                }
+            });
+
+            if constexpr (compensated) {
+                return (*partials[0] += init).value();
+            } else {
+                return std::invoke(op, std::move(init), std::move(*partials[0]));
+            }
+        }
+
+        template<class R, class Op, typename T, bool compensated>
+            requires requires (const Reduce &self, const R &r, const Op &op, T init, Reproducible<compensated> how) {
+                self(execution::seq, r, op, std::move(init), how);
+            }
+        auto operator()(const R &r, const Op &op, T init, Reproducible<compensated> how) const -> T {
+            return operator()(execution::seq, r, op, std::move(init), how);
+        }
+    };
+
+    constexpr inline Reduce reduce;
 }
 
 #endif//UNDERSCORE_CPP_REDUCIBLE_HPP
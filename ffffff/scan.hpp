@@ -0,0 +1,204 @@
+#ifndef UNDERSCORE_CPP_SCAN_HPP
+#define UNDERSCORE_CPP_SCAN_HPP
+
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+#include "execution.hpp"
+#include "reducible.hpp"
+#include "simd.hpp"
+
+/*
+* fff::scan Reducible_TD
+*
+* Prefix folds of a range, for offsets, bucket boundaries, running totals, ...
+* scan is the inclusive one, exclusive_scan the exclusive one.
+* Any binary op works, fff::reducible(...) included.
+*
+* @example fff::scan(std::vector{1, 2, 3, 4}, std::plus<>()) == std::vector{1, 3, 6, 10}
+* @example fff::exclusive_scan(std::vector{1, 2, 3, 4}, std::plus<>(), 0) == std::vector{0, 1, 3, 6}
+*/
+namespace fff {
+
+    namespace liated {
+
+        /**
+        * determines whether scanning R by Op into T is a prefix sum that fff::simd::prefix_sum can do
+        */
+        template<class R, class Op, typename T>
+        concept simd_scan = is_plus<std::remove_cvref_t<Op>, T>::value
+            and std::ranges::contiguous_range<const R>
+            and std::is_same_v<std::ranges::range_value_t<R>, T>
+            and simd::liated::scan_lane<T>::width != 0;
+
+        /**
+        * Scans [first, last) into out, starting from acc.\n
+        * inclusive : out[i] = acc op in[0] op ... op in[i]\n
+        * exclusive : out[i] = acc op in[0] op ... op in[i - 1]\n
+        * An inclusive scan without acc starts from in[0].
+        */
+        template<bool exclusive, class It, class S, class Out, class Op, typename T>
+        constexpr void scan_from(It first, S last, Out out, const Op &op, std::optional<T> acc) {
+            if (not acc) {
+                if (first == last) {
+                    return;
+                }
+                acc.emplace(*first);
+                *out = *acc;
+                ++first, ++out;
+            }
+
+            for (; first != last; ++first, ++out) {
+                if constexpr (exclusive) {
+                    *out = *acc;
+                    *acc = std::invoke(op, std::move(*acc), *first);
+                } else {
+                    *acc = std::invoke(op, std::move(*acc), *first);
+                    *out = *acc;
+                }
+            }
+        }
+
+        /**
+        * scan_from for a sum of int or float, by fff::simd::prefix_sum.
+        */
+        template<bool exclusive, typename T>
+        void scan_from(const T *in, T *out, std::size_t n, std::optional<T> acc) noexcept {
+            if (n == 0) {
+                return;
+            }
+            if (not acc) {
+                out[0] = in[0];
+                simd::prefix_sum(in + 1, out + 1, n - 1, in[0]);
+            } else if constexpr (exclusive) {
+                out[0] = *acc;
+                simd::prefix_sum(in, out + 1, n - 1, *acc);
+            } else {
+                simd::prefix_sum(in, out, n, *acc);
+            }
+        }
+
+        /**
+        * The scan that fff::scan and fff::exclusive_scan share.\n
+        * With a parallel policy, a random-access range and an associative op (see fff::is_associative),
+        * it is a two-pass blocked prefix : every block but the last is reduced on its own (pass 1),
+        * the block totals are scanned into the carry of every block, then every block is scanned from its carry (pass 2).
+        */
+        template<bool exclusive, class Policy, class R, class Op, typename T>
+        auto scan_range(Policy &&, const R &r, const Op &op, std::optional<T> init) -> std::vector<T> {
+            std::vector<T> ret;
+
+            if constexpr (execution::parallel<Policy> and splittable<const R> and is_associative_v<Op>
+                          and std::default_initializable<T>
+                          and std::convertible_to<std::invoke_result_t<const Op &, T, T>, T>) {
+                const BlockPlan plan(std::ranges::size(r), worker_count(), 4096);
+
+                if (plan.blocks > 1) {
+                    std::vector<std::optional<T>> carry(plan.blocks);
+                    carry[0] = std::move(init);
+
+                    blocked_for(plan, [&r, &op, &carry, &plan](std::size_t b, std::size_t first, std::size_t last) {
+                        if (b + 1 == plan.blocks) {
+                            return;
+                        }
+                        carry[b + 1] = fold_block<T>(r, op, first, last);
+                    });
+
+                    for (std::size_t b = 1; b < plan.blocks; ++b) {
+                        if (carry[b - 1]) {
+                            carry[b] = std::invoke(op, *carry[b - 1], std::move(*carry[b]));
+                        }
+                    }
+
+                    ret.resize(plan.n);
+
+                    blocked_for(plan, [&r, &op, &carry, &ret](std::size_t b, std::size_t first, std::size_t last) {
+                        if constexpr (simd_scan<R, Op, T>) {
+                            scan_from<exclusive>(std::ranges::data(r) + first, ret.data() + first, last - first, std::move(carry[b]));
+                        } else {
+                            auto it = std::ranges::begin(r);
+                            scan_from<exclusive>(it + first, it + last, ret.begin() + first, op, std::move(carry[b]));
+                        }
+                    });
+
+                    return ret;
+                }
+            }
+
+            if constexpr (simd_scan<R, Op, T>) {
+                ret.resize(std::ranges::size(r));
+                scan_from<exclusive>(std::ranges::data(r), ret.data(), ret.size(), std::move(init));
+            } else {
+                if constexpr (std::ranges::sized_range<const R>) {
+                    ret.reserve(std::ranges::size(r));
+                }
+                scan_from<exclusive>(std::ranges::begin(r), std::ranges::end(r), std::back_inserter(ret), op, std::move(init));
+            }
+            return ret;
+        }
+    }
+
+    /**
+    * The inclusive scan : ret[i] = init op r[0] op ... op r[i], or r[0] op ... op r[i] without init.
+    * A sum of int or float over a contiguous range runs a whole SIMD register at a time.
+    * @example auto ends = fff::scan(fff::execution::par, sizes, std::plus<>());
+    */
+    struct Scan {
+        template<class R, class Op, typename T = std::ranges::range_value_t<R>>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(const R &r, const Op &op) const -> std::vector<T> {
+            return liated::scan_range<false>(execution::seq, r, op, std::optional<T>());
+        }
+
+        template<class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(const R &r, const Op &op, T init) const -> std::vector<T> {
+            return liated::scan_range<false>(execution::seq, r, op, std::optional<T>(std::move(init)));
+        }
+
+        template<execution::policy Policy, class R, class Op, typename T = std::ranges::range_value_t<R>>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(Policy &&policy, const R &r, const Op &op) const -> std::vector<T> {
+            return liated::scan_range<false>(policy, r, op, std::optional<T>());
+        }
+
+        template<execution::policy Policy, class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(Policy &&policy, const R &r, const Op &op, T init) const -> std::vector<T> {
+            return liated::scan_range<false>(policy, r, op, std::optional<T>(std::move(init)));
+        }
+    };
+
+    /**
+    * The exclusive scan : ret[i] = init op r[0] op ... op r[i - 1], so ret[0] == init.
+    * @example auto offsets = fff::exclusive_scan(fff::execution::par, sizes, std::plus<>(), std::size_t(0));
+    */
+    struct ExclusiveScan {
+        template<class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(const R &r, const Op &op, T init) const -> std::vector<T> {
+            return liated::scan_range<true>(execution::seq, r, op, std::optional<T>(std::move(init)));
+        }
+
+        template<execution::policy Policy, class R, class Op, typename T>
+            requires std::ranges::input_range<const R>
+            and std::convertible_to<std::invoke_result_t<const Op &, T, std::ranges::range_reference_t<const R>>, T>
+        auto operator()(Policy &&policy, const R &r, const Op &op, T init) const -> std::vector<T> {
+            return liated::scan_range<true>(policy, r, op, std::optional<T>(std::move(init)));
+        }
+    };
+
+    constexpr inline Scan scan;
+    constexpr inline ExclusiveScan exclusive_scan;
+}
+
+#endif//UNDERSCORE_CPP_SCAN_HPP
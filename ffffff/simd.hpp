@@ -0,0 +1,974 @@
+#ifndef UNDERSCORE_CPP_SIMD_HPP
+#define UNDERSCORE_CPP_SIMD_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <functional>
+#include <ranges>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "basic_ops.hpp"
+#include "bind.hpp"
+#include "tmf.hpp"
+
+/*
+* fff::simd Reducible_TD
+*
+* Explicitly vectorized kernels for the small, stateless function objects of the library.
+* The widest instruction set enabled at compile time is used (AVX2, then SSE2);
+* without any of them every kernel is disabled and the generic loops are used.
+*/
+namespace fff::simd {
+
+    /**
+    * The comparisons that have a SIMD kernel, "x (cmp) c".
+    */
+    enum class cmp { lt, le, gt, ge, eq, ne };
+
+    namespace liated {
+
+#if defined(__AVX2__)
+        /**
+        * The _CMP_ immediate of a comparison. Every comparison but ne is false for NaN, like the C++ operators.
+        */
+        constexpr int avx_predicate(cmp k) noexcept {
+            switch (k) {
+            case cmp::lt: return _CMP_LT_OQ;
+            case cmp::le: return _CMP_LE_OQ;
+            case cmp::gt: return _CMP_GT_OQ;
+            case cmp::ge: return _CMP_GE_OQ;
+            case cmp::eq: return _CMP_EQ_OQ;
+            default:      return _CMP_NEQ_UQ;
+            }
+        }
+
+        /**
+        * avx_predicate(k) as a constant, since the intrinsics need an immediate even in an unoptimized build.
+        */
+        template<cmp k>
+        constexpr inline int avx_predicate_v = avx_predicate(k);
+#endif
+
+        /**
+        * lane\<T> : one SIMD register of T, and the operations on it.\n
+        * lane\<T>::width == 0 means that T has no kernel on this target.
+        */
+        template<typename T>
+        struct lane {
+            constexpr static std::size_t width = 0;
+        };
+
+#if defined(__AVX2__)
+        template<>
+        struct lane<int> {
+            using reg = __m256i;
+            constexpr static std::size_t width = 8;
+            constexpr static bool has_mul = true;
+            constexpr static bool has_flip = true;
+
+            static reg load(const int *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+            static void store(int *p, reg x) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), x); }
+            static reg set1(int c) noexcept { return _mm256_set1_epi32(c); }
+            static reg add(reg a, reg b) noexcept { return _mm256_add_epi32(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm256_sub_epi32(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm256_mullo_epi32(a, b); }
+            static reg flip(reg a) noexcept { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+
+            constexpr static unsigned full = 0xFF;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                if constexpr (k == cmp::lt) {
+                    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(c, x)));
+                } else if constexpr (k == cmp::gt) {
+                    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, c)));
+                } else if constexpr (k == cmp::eq) {
+                    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, c)));
+                } else if constexpr (k == cmp::le) {
+                    return ~mask<cmp::gt>(x, c) & full;
+                } else if constexpr (k == cmp::ge) {
+                    return ~mask<cmp::lt>(x, c) & full;
+                } else {
+                    return ~mask<cmp::eq>(x, c) & full;
+                }
+            }
+        };
+
+        template<>
+        struct lane<float> {
+            using reg = __m256;
+            constexpr static std::size_t width = 8;
+            constexpr static bool has_mul = true;
+            constexpr static bool has_flip = false;
+
+            static reg load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+            static void store(float *p, reg x) noexcept { _mm256_storeu_ps(p, x); }
+            static reg set1(float c) noexcept { return _mm256_set1_ps(c); }
+            static reg add(reg a, reg b) noexcept { return _mm256_add_ps(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm256_sub_ps(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm256_mul_ps(a, b); }
+
+            constexpr static unsigned full = 0xFF;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                return _mm256_movemask_ps(_mm256_cmp_ps(x, c, avx_predicate_v<k>));
+            }
+        };
+
+        template<>
+        struct lane<double> {
+            using reg = __m256d;
+            constexpr static std::size_t width = 4;
+            constexpr static bool has_mul = true;
+            constexpr static bool has_flip = false;
+
+            static reg load(const double *p) noexcept { return _mm256_loadu_pd(p); }
+            static void store(double *p, reg x) noexcept { _mm256_storeu_pd(p, x); }
+            static reg set1(double c) noexcept { return _mm256_set1_pd(c); }
+            static reg add(reg a, reg b) noexcept { return _mm256_add_pd(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm256_sub_pd(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm256_mul_pd(a, b); }
+
+            constexpr static unsigned full = 0xF;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                return _mm256_movemask_pd(_mm256_cmp_pd(x, c, avx_predicate_v<k>));
+            }
+        };
+#elif defined(__SSE2__)
+        template<>
+        struct lane<int> {
+            using reg = __m128i;
+            constexpr static std::size_t width = 4;
+#if defined(__SSE4_1__)
+            constexpr static bool has_mul = true;
+#else
+            constexpr static bool has_mul = false;
+#endif
+            constexpr static bool has_flip = true;
+
+            static reg load(const int *p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+            static void store(int *p, reg x) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x); }
+            static reg set1(int c) noexcept { return _mm_set1_epi32(c); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_epi32(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm_sub_epi32(a, b); }
+#if defined(__SSE4_1__)
+            static reg mul(reg a, reg b) noexcept { return _mm_mullo_epi32(a, b); }
+#endif
+            static reg flip(reg a) noexcept { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+
+            constexpr static unsigned full = 0xF;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                if constexpr (k == cmp::lt) {
+                    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(x, c)));
+                } else if constexpr (k == cmp::gt) {
+                    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, c)));
+                } else if constexpr (k == cmp::eq) {
+                    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, c)));
+                } else if constexpr (k == cmp::le) {
+                    return ~mask<cmp::gt>(x, c) & full;
+                } else if constexpr (k == cmp::ge) {
+                    return ~mask<cmp::lt>(x, c) & full;
+                } else {
+                    return ~mask<cmp::eq>(x, c) & full;
+                }
+            }
+        };
+
+        template<>
+        struct lane<float> {
+            using reg = __m128;
+            constexpr static std::size_t width = 4;
+            constexpr static bool has_mul = true;
+            constexpr static bool has_flip = false;
+
+            static reg load(const float *p) noexcept { return _mm_loadu_ps(p); }
+            static void store(float *p, reg x) noexcept { _mm_storeu_ps(p, x); }
+            static reg set1(float c) noexcept { return _mm_set1_ps(c); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_ps(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm_sub_ps(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm_mul_ps(a, b); }
+
+            constexpr static unsigned full = 0xF;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                if constexpr (k == cmp::lt) {
+                    return _mm_movemask_ps(_mm_cmplt_ps(x, c));
+                } else if constexpr (k == cmp::le) {
+                    return _mm_movemask_ps(_mm_cmple_ps(x, c));
+                } else if constexpr (k == cmp::gt) {
+                    return _mm_movemask_ps(_mm_cmpgt_ps(x, c));
+                } else if constexpr (k == cmp::ge) {
+                    return _mm_movemask_ps(_mm_cmpge_ps(x, c));
+                } else if constexpr (k == cmp::eq) {
+                    return _mm_movemask_ps(_mm_cmpeq_ps(x, c));
+                } else {
+                    return _mm_movemask_ps(_mm_cmpneq_ps(x, c));
+                }
+            }
+        };
+
+        template<>
+        struct lane<double> {
+            using reg = __m128d;
+            constexpr static std::size_t width = 2;
+            constexpr static bool has_mul = true;
+            constexpr static bool has_flip = false;
+
+            static reg load(const double *p) noexcept { return _mm_loadu_pd(p); }
+            static void store(double *p, reg x) noexcept { _mm_storeu_pd(p, x); }
+            static reg set1(double c) noexcept { return _mm_set1_pd(c); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_pd(a, b); }
+            static reg sub(reg a, reg b) noexcept { return _mm_sub_pd(a, b); }
+            static reg mul(reg a, reg b) noexcept { return _mm_mul_pd(a, b); }
+
+            constexpr static unsigned full = 0x3;
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                if constexpr (k == cmp::lt) {
+                    return _mm_movemask_pd(_mm_cmplt_pd(x, c));
+                } else if constexpr (k == cmp::le) {
+                    return _mm_movemask_pd(_mm_cmple_pd(x, c));
+                } else if constexpr (k == cmp::gt) {
+                    return _mm_movemask_pd(_mm_cmpgt_pd(x, c));
+                } else if constexpr (k == cmp::ge) {
+                    return _mm_movemask_pd(_mm_cmpge_pd(x, c));
+                } else if constexpr (k == cmp::eq) {
+                    return _mm_movemask_pd(_mm_cmpeq_pd(x, c));
+                } else {
+                    return _mm_movemask_pd(_mm_cmpneq_pd(x, c));
+                }
+            }
+        };
+#endif
+
+        /*
+        * Kernels : what to do with one register (vec) and with one leftover element (scalar).
+        * c is the bound constant, already converted to T (unused by unary kernels).
+        */
+
+        struct flip_k {
+            template<typename T>
+            constexpr static bool supports = lane<T>::has_flip;
+
+            template<class L>
+            static auto vec(typename L::reg x, typename L::reg) noexcept { return L::flip(x); }
+
+            template<typename T>
+            static T scalar(T x, T) noexcept { return ~x; }
+        };
+
+        struct add_k {
+            template<typename T>
+            constexpr static bool supports = true;
+
+            template<class L>
+            static auto vec(typename L::reg x, typename L::reg c) noexcept { return L::add(x, c); }
+
+            template<typename T>
+            static T scalar(T x, T c) noexcept { return x + c; }
+        };
+
+        /** x - c */
+        struct sub_k {
+            template<typename T>
+            constexpr static bool supports = true;
+
+            template<class L>
+            static auto vec(typename L::reg x, typename L::reg c) noexcept { return L::sub(x, c); }
+
+            template<typename T>
+            static T scalar(T x, T c) noexcept { return x - c; }
+        };
+
+        /** c - x */
+        struct rsub_k {
+            template<typename T>
+            constexpr static bool supports = true;
+
+            template<class L>
+            static auto vec(typename L::reg x, typename L::reg c) noexcept { return L::sub(c, x); }
+
+            template<typename T>
+            static T scalar(T x, T c) noexcept { return c - x; }
+        };
+
+        struct mul_k {
+            template<typename T>
+            constexpr static bool supports = lane<T>::has_mul;
+
+            template<class L>
+            static auto vec(typename L::reg x, typename L::reg c) noexcept { return L::mul(x, c); }
+
+            template<typename T>
+            static T scalar(T x, T c) noexcept { return x * c; }
+        };
+
+        /**
+        * Maps the binary std:: function objects to (kernel when bound on the right, kernel when bound on the left).
+        */
+        template<class Op>
+        struct binary_kernel {
+            constexpr static bool known = false;
+        };
+
+        template<typename U>
+        struct binary_kernel<std::plus<U>> {
+            constexpr static bool known = true;
+            using r_bound = add_k;
+            using l_bound = add_k;
+        };
+
+        template<typename U>
+        struct binary_kernel<std::minus<U>> {
+            constexpr static bool known = true;
+            using r_bound = sub_k;
+            using l_bound = rsub_k;
+        };
+
+        template<typename U>
+        struct binary_kernel<std::multiplies<U>> {
+            constexpr static bool known = true;
+            using r_bound = mul_k;
+            using l_bound = mul_k;
+        };
+    }
+
+    /**
+    * kernel_traits\<F> tells whether F is a function object with a known SIMD kernel.
+    * @member known true if so
+    * @member kernel the kernel type
+    * @member constant the bound constant (for bound binary operators)
+    */
+    template<class F>
+    struct kernel_traits {
+        constexpr static bool known = false;
+    };
+
+    template<>
+    struct kernel_traits<flip_f> {
+        constexpr static bool known = true;
+        using kernel = liated::flip_k;
+        constexpr static int constant = 0;
+    };
+
+    template<class Op, auto c>
+        requires liated::binary_kernel<Op>::known and std::is_arithmetic_v<type_of<c>>
+    struct kernel_traits<Static_R_Bind_f<Op, value_holder<c>>> {
+        constexpr static bool known = true;
+        using kernel = typename liated::binary_kernel<Op>::r_bound;
+        constexpr static auto constant = c;
+    };
+
+    template<class Op, auto c>
+        requires liated::binary_kernel<Op>::known and std::is_arithmetic_v<type_of<c>>
+    struct kernel_traits<Static_L_Bind_f<Op, value_holder<c>>> {
+        constexpr static bool known = true;
+        using kernel = typename liated::binary_kernel<Op>::l_bound;
+        constexpr static auto constant = c;
+    };
+
+    /**
+    * determines whether "T -> T by F" has a SIMD kernel on this target
+    */
+    template<typename T, class F>
+    concept kernel_for =
+        liated::lane<T>::width != 0
+        and kernel_traits<std::decay_t<F>>::known
+        and std::is_same_v<std::invoke_result_t<const std::decay_t<F> &, const T &>, T>
+        and kernel_traits<std::decay_t<F>>::kernel::template supports<T>;
+
+    /**
+    * determines whether fff::Map may run "Cont -> Ret by F" with a SIMD kernel
+    */
+    template<class Cont, class Ret, class F>
+    concept mappable =
+        std::ranges::contiguous_range<const Cont>
+        and std::ranges::contiguous_range<Ret>
+        and std::is_same_v<std::ranges::range_value_t<Ret>, std::ranges::range_value_t<Cont>>
+        and kernel_for<std::ranges::range_value_t<Cont>, F>;
+
+    /**
+    * determines whether fff::map_into may run "Cont -> *It by F" with a SIMD kernel
+    */
+    template<class Cont, class It, class F>
+    concept mappable_into =
+        std::ranges::contiguous_range<const Cont>
+        and std::contiguous_iterator<It>
+        and std::is_same_v<std::iter_value_t<It>, std::ranges::range_value_t<Cont>>
+        and kernel_for<std::ranges::range_value_t<Cont>, F>;
+
+    /**
+    * out[i] = f(in[i]) for i in [0, n), by the SIMD kernel of F.
+    * out may be in itself, for an in-place map.
+    */
+    template<typename T, class F>
+        requires kernel_for<T, F>
+    void map_kernel(const T *in, T *out, std::size_t n, const F &) noexcept {
+        using L = liated::lane<T>;
+        using K = typename kernel_traits<std::decay_t<F>>::kernel;
+
+        const T c = static_cast<T>(kernel_traits<std::decay_t<F>>::constant);
+        const auto vc = L::set1(c);
+
+        std::size_t i = 0;
+        for (; i + L::width <= n; i += L::width) {
+            L::store(out + i, K::template vec<L>(L::load(in + i), vc));
+        }
+        for (; i < n; ++i) {
+            out[i] = K::scalar(in[i], c);
+        }
+    }
+
+    namespace liated {
+
+        /**
+        * The number of columns of fff::simd::sum : 128 bytes of T, a whole number of registers on every target.
+        */
+        template<typename T>
+        constexpr inline std::size_t columns = 128 / sizeof(T);
+
+        /**
+        * determines whether fff::simd::sum adds up T : any arithmetic type but bool, with or without a kernel on this target
+        */
+        template<typename T>
+        concept summable = std::is_arithmetic_v<T> and not std::is_same_v<T, bool>;
+
+        /**
+        * Adds in[0, n), one row of columns\<T> elements at a time, into the column accumulators hi[0, columns)
+        * (and, with_error, the rounding error of every addition into lo[0, columns), by 2Sum).
+        * Column k gets in[k], in[k + columns], in[k + 2 * columns], ... in this order on every target,
+        * whatever the width of its registers, or without SIMD at all.
+        * @return the number of elements added : those of the whole rows
+        */
+        template<bool with_error, typename T>
+        std::size_t add_columns(const T *in, std::size_t n, T *hi, T *lo) noexcept {
+            constexpr std::size_t C = columns<T>;
+            std::size_t i = 0;
+
+            if constexpr (lane<T>::width != 0) {
+                using L = lane<T>;
+                constexpr std::size_t W = L::width;
+                static_assert(C % W == 0);
+
+                typename L::reg h[C / W], l[C / W];
+                for (std::size_t r = 0; r < C / W; ++r) {
+                    h[r] = l[r] = L::set1(T(0));
+                }
+
+                for (; i + C <= n; i += C) {
+                    for (std::size_t r = 0; r < C / W; ++r) {
+                        const auto x = L::load(in + i + r * W);
+                        if constexpr (with_error) {
+                            const auto s = L::add(h[r], x);
+                            const auto z = L::sub(s, h[r]);
+                            l[r] = L::add(l[r], L::add(L::sub(h[r], L::sub(s, z)), L::sub(x, z)));
+                            h[r] = s;
+                        } else {
+                            h[r] = L::add(h[r], x);
+                        }
+                    }
+                }
+
+                for (std::size_t r = 0; r < C / W; ++r) {
+                    L::store(hi + r * W, h[r]);
+                    if constexpr (with_error) {
+                        L::store(lo + r * W, l[r]);
+                    }
+                }
+            } else {
+                std::fill(hi, hi + C, T(0));
+                if constexpr (with_error) {
+                    std::fill(lo, lo + C, T(0));
+                }
+
+                for (; i + C <= n; i += C) {
+                    for (std::size_t k = 0; k < C; ++k) {
+                        const T x = in[i + k];
+                        if constexpr (with_error) {
+                            const T s = hi[k] + x;
+                            const T z = s - hi[k];
+                            lo[k] += (hi[k] - (s - z)) + (x - z);
+                            hi[k] = s;
+                        } else {
+                            hi[k] += x;
+                        }
+                    }
+                }
+            }
+            return i;
+        }
+
+        /**
+        * parts[0] += parts[1], parts[2] += parts[3], ..., then parts[0] += parts[2], ... : a tree that depends only on n.
+        */
+        template<typename X>
+        void add_pairwise(X *parts, std::size_t n) noexcept {
+            for (std::size_t step = 1; step < n; step *= 2) {
+                for (std::size_t k = 0; k + step < n; k += 2 * step) {
+                    parts[k] += parts[k + step];
+                }
+            }
+        }
+    }
+
+    /**
+    * in[0] + ... + in[n - 1], by one accumulator per column of 128 bytes (see liated::add_columns),
+    * combined pairwise; the elements after the last whole row are added last, in order.
+    * The additions do NOT happen in the sequential order; a floating-point sum may differ in the last bits.
+    * But their order depends only on n : an SSE2 build, an AVX2 build and a build without SIMD give the same sum, bit for bit.
+    */
+    template<liated::summable T>
+    T sum(const T *in, std::size_t n) noexcept {
+        constexpr std::size_t C = liated::columns<T>;
+
+        T cols[C];
+        std::size_t i = liated::add_columns<false>(in, n, cols, static_cast<T *>(nullptr));
+        liated::add_pairwise(cols, C);
+
+        T s = cols[0];
+        for (; i < n; ++i) {
+            s += in[i];
+        }
+        return s;
+    }
+
+    /**
+    * A floating-point sum that keeps its own rounding error : the sum is hi + lo, to about twice the precision of T.
+    * Every addition is a 2Sum (Knuth), which gets the exact error of hi + x without any comparison or branch.
+    */
+    template<typename T>
+    struct compensated {
+        T hi = 0;
+        T lo = 0;
+
+        constexpr compensated &operator+=(T x) noexcept {
+            const T s = hi + x;
+            const T z = s - hi;
+            lo += (hi - (s - z)) + (x - z);
+            hi = s;
+            return *this;
+        }
+
+        constexpr compensated &operator+=(const compensated &other) noexcept {
+            *this += other.hi;
+            lo += other.lo;
+            return *this;
+        }
+
+        [[nodiscard]] constexpr T value() const noexcept {
+            return hi + lo;
+        }
+    };
+
+    /**
+    * in[0] + ... + in[n - 1] as a compensated sum, in the order of fff::simd::sum (so the same on every target),
+    * every column keeping its own error. Without a kernel for T on this target, the columns are added one element at a time.
+    */
+    template<std::floating_point T>
+    compensated<T> compensated_sum(const T *in, std::size_t n) noexcept {
+        constexpr std::size_t C = liated::columns<T>;
+
+        T hi[C], lo[C];
+        std::size_t i = liated::add_columns<true>(in, n, hi, lo);
+
+        compensated<T> parts[C];
+        for (std::size_t k = 0; k < C; ++k) {
+            parts[k] = compensated<T>{hi[k], lo[k]};
+        }
+        liated::add_pairwise(parts, C);
+
+        compensated<T> ret = parts[0];
+        for (; i < n; ++i) {
+            ret += in[i];
+        }
+        return ret;
+    }
+
+    namespace liated {
+
+        /**
+        * scan_lane\<T> : one 128-bit register of T, and its in-register prefix sum, for int and float.
+        * The prefix is a log-step shift-and-add, which stays inside one 128-bit lane on every target.
+        * scan_lane\<T>::width == 0 means that T has no prefix kernel on this target.
+        */
+        template<typename T>
+        struct scan_lane {
+            constexpr static std::size_t width = 0;
+        };
+
+#if defined(__SSE2__)
+        template<>
+        struct scan_lane<int> {
+            using reg = __m128i;
+            constexpr static std::size_t width = 4;
+
+            static reg load(const int *p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+            static void store(int *p, reg x) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x); }
+            static reg set1(int c) noexcept { return _mm_set1_epi32(c); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_epi32(a, b); }
+            static reg prefix(reg x) noexcept {
+                x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            }
+            static reg last(reg x) noexcept { return _mm_shuffle_epi32(x, 0xFF); }
+            static int first(reg x) noexcept { return _mm_cvtsi128_si32(x); }
+        };
+
+        template<>
+        struct scan_lane<float> {
+            using reg = __m128;
+            constexpr static std::size_t width = 4;
+
+            static reg load(const float *p) noexcept { return _mm_loadu_ps(p); }
+            static void store(float *p, reg x) noexcept { _mm_storeu_ps(p, x); }
+            static reg set1(float c) noexcept { return _mm_set1_ps(c); }
+            static reg add(reg a, reg b) noexcept { return _mm_add_ps(a, b); }
+            static reg prefix(reg x) noexcept {
+                x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+                return _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+            }
+            static reg last(reg x) noexcept { return _mm_shuffle_ps(x, x, 0xFF); }
+            static float first(reg x) noexcept { return _mm_cvtss_f32(x); }
+        };
+#endif
+    }
+
+    /**
+    * out[i] = carry + in[0] + ... + in[i] for i in [0, n), a whole register at a time.
+    * Only the carry from one register to the next is a serial dependency, instead of every element.
+    * out may be in itself, for an in-place scan.
+    * Inside a register the additions do NOT happen in the sequential order; a floating-point prefix may differ in the last bits.
+    * @return carry + in[0] + ... + in[n - 1]
+    */
+    template<typename T>
+        requires (liated::scan_lane<T>::width != 0)
+    T prefix_sum(const T *in, T *out, std::size_t n, T carry) noexcept {
+        using L = liated::scan_lane<T>;
+
+        auto c = L::set1(carry);
+
+        const std::size_t body = n - n % L::width;
+
+        std::size_t i = 0;
+        for (; i < body; i += L::width) {
+            const auto x = L::add(L::prefix(L::load(in + i)), c);
+            L::store(out + i, x);
+            c = L::last(x);
+        }
+
+        T s = L::first(c);
+        for (; i < n; ++i) {
+            s += in[i];
+            out[i] = s;
+        }
+        return s;
+    }
+}
+
+/*
+* fff::simd stream compaction Reducible_TD
+*
+* Filter without a branch per element : the predicate is evaluated on a whole register into a bit mask,
+* and the survivors are packed by compress-store (AVX-512), by a permutation table (AVX2),
+* or by mask-driven stores (otherwise).
+*/
+namespace fff::simd {
+
+    namespace liated {
+
+        /**
+        * Maps the comparison std:: function objects to (comparison when bound on the right, when bound on the left).
+        * c < x is x > c, and so on.
+        */
+        template<class Op>
+        struct comparison {
+            constexpr static bool known = false;
+        };
+
+        template<cmp r, cmp l>
+        struct comparison_as {
+            constexpr static bool known = true;
+            constexpr static cmp r_bound = r;
+            constexpr static cmp l_bound = l;
+        };
+
+        template<> struct comparison<std::less<>> : comparison_as<cmp::lt, cmp::gt> {};
+        template<> struct comparison<std::less_equal<>> : comparison_as<cmp::le, cmp::ge> {};
+        template<> struct comparison<std::greater<>> : comparison_as<cmp::gt, cmp::lt> {};
+        template<> struct comparison<std::greater_equal<>> : comparison_as<cmp::ge, cmp::le> {};
+        template<> struct comparison<std::equal_to<>> : comparison_as<cmp::eq, cmp::eq> {};
+        template<> struct comparison<std::not_equal_to<>> : comparison_as<cmp::ne, cmp::ne> {};
+
+#if defined(__AVX512F__)
+        /**
+        * A 512-bit register of T, only used to compress-store the survivors.
+        */
+        template<typename T>
+        struct wide_lane {
+            constexpr static std::size_t width = 0;
+        };
+
+        template<>
+        struct wide_lane<int> {
+            using reg = __m512i;
+            constexpr static std::size_t width = 16;
+
+            static reg load(const int *p) noexcept { return _mm512_loadu_si512(p); }
+            static reg set1(int c) noexcept { return _mm512_set1_epi32(c); }
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept {
+                constexpr int imm = k == cmp::lt ? _MM_CMPINT_LT : k == cmp::le ? _MM_CMPINT_LE
+                                  : k == cmp::gt ? _MM_CMPINT_NLE : k == cmp::ge ? _MM_CMPINT_NLT
+                                  : k == cmp::eq ? _MM_CMPINT_EQ : _MM_CMPINT_NE;
+                return _mm512_cmp_epi32_mask(x, c, imm);
+            }
+
+            static void compress(int *out, unsigned m, reg x) noexcept { _mm512_mask_compressstoreu_epi32(out, m, x); }
+        };
+
+        template<>
+        struct wide_lane<float> {
+            using reg = __m512;
+            constexpr static std::size_t width = 16;
+
+            static reg load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+            static reg set1(float c) noexcept { return _mm512_set1_ps(c); }
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept { return _mm512_cmp_ps_mask(x, c, avx_predicate_v<k>); }
+
+            static void compress(float *out, unsigned m, reg x) noexcept { _mm512_mask_compressstoreu_ps(out, m, x); }
+        };
+
+        template<>
+        struct wide_lane<double> {
+            using reg = __m512d;
+            constexpr static std::size_t width = 8;
+
+            static reg load(const double *p) noexcept { return _mm512_loadu_pd(p); }
+            static reg set1(double c) noexcept { return _mm512_set1_pd(c); }
+
+            template<cmp k>
+            static unsigned mask(reg x, reg c) noexcept { return _mm512_cmp_pd_mask(x, c, avx_predicate_v<k>); }
+
+            static void compress(double *out, unsigned m, reg x) noexcept { _mm512_mask_compressstoreu_pd(out, m, x); }
+        };
+#endif
+
+#if defined(__AVX2__)
+        /**
+        * permute_table\<lanes>[m] : the _mm256_permutevar8x32 indices that pack the lanes selected by m to the front.
+        * An 8-byte lane is moved as two 4-byte halves.
+        */
+        template<std::size_t lanes>
+        constexpr auto make_permute_table() noexcept {
+            std::array<std::array<int, 8>, (1u << lanes)> table{};
+
+            for (unsigned m = 0; m < (1u << lanes); ++m) {
+                std::size_t k = 0;
+                for (std::size_t j = 0; j < lanes; ++j) {
+                    if (m >> j & 1u) {
+                        for (std::size_t h = 0; h < 8 / lanes; ++h) {
+                            table[m][k++] = static_cast<int>(j * (8 / lanes) + h);
+                        }
+                    }
+                }
+            }
+            return table;
+        }
+
+        template<std::size_t lanes>
+        alignas(32) constexpr inline auto permute_table = make_permute_table<lanes>();
+#endif
+
+        /**
+        * Packs the lanes of x selected by m to out, and returns how many were packed.
+        * May write up to a whole register to out, so out needs L::width elements of room.
+        */
+        template<class L, typename T>
+        std::size_t pack(T *out, unsigned m, [[maybe_unused]] typename L::reg x, const T *in) noexcept {
+#if defined(__AVX2__)
+            if constexpr (sizeof(typename L::reg) == 32) {
+                const auto idx = _mm256_load_si256(reinterpret_cast<const __m256i *>(permute_table<L::width>[m].data()));
+                if constexpr (std::is_same_v<T, int>) {
+                    L::store(out, _mm256_permutevar8x32_epi32(x, idx));
+                } else if constexpr (std::is_same_v<T, float>) {
+                    L::store(out, _mm256_permutevar8x32_ps(x, idx));
+                } else {
+                    L::store(out, _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(x), idx)));
+                }
+                return static_cast<std::size_t>(std::popcount(m));
+            }
+#endif
+            std::size_t k = 0;
+            for (std::size_t j = 0; j < L::width; ++j) {
+                out[k] = in[j];
+                k += m >> j & 1u;
+            }
+            return k;
+        }
+    }
+
+    /**
+    * predicate_traits\<P> tells whether P is a comparison with a constant that has a SIMD kernel.
+    * @member known true if so
+    * @member kind the comparison, "x (kind) constant"
+    * @member constant the bound constant
+    */
+    template<class P>
+    struct predicate_traits {
+        constexpr static bool known = false;
+    };
+
+    template<class Op, auto c>
+        requires liated::comparison<Op>::known and std::is_arithmetic_v<type_of<c>>
+    struct predicate_traits<Static_R_Bind_f<Op, value_holder<c>>> {
+        constexpr static bool known = true;
+        constexpr static cmp kind = liated::comparison<Op>::r_bound;
+        constexpr static auto constant = c;
+    };
+
+    template<class Op, auto c>
+        requires liated::comparison<Op>::known and std::is_arithmetic_v<type_of<c>>
+    struct predicate_traits<Static_L_Bind_f<Op, value_holder<c>>> {
+        constexpr static bool known = true;
+        constexpr static cmp kind = liated::comparison<Op>::l_bound;
+        constexpr static auto constant = c;
+    };
+
+    /**
+    * determines whether "x (cmp) c" on T has a SIMD kernel on this target.
+    * The comparison must happen in T itself, e.g. NOT int x < 2.5
+    */
+    template<typename T, class P>
+    concept compare_kernel_for =
+        liated::lane<T>::width != 0
+        and predicate_traits<std::decay_t<P>>::known
+        and std::is_same_v<std::common_type_t<T, std::decay_t<decltype(predicate_traits<std::decay_t<P>>::constant)>>, T>;
+
+    /**
+    * determines whether fff::Filter may run over Cont without a branch per element:
+    * contiguous arithmetic elements, with any bool predicate
+    */
+    template<class Cont, class P>
+    concept compactable =
+        std::ranges::contiguous_range<const Cont>
+        and std::is_arithmetic_v<std::ranges::range_value_t<Cont>>
+        and std::convertible_to<std::invoke_result_t<const P &, const std::ranges::range_value_t<Cont> &>, bool>;
+
+    /**
+    * The number of x in in[0, n) with (pred(x) == keep).
+    */
+    template<bool keep, typename T, class P>
+        requires compare_kernel_for<T, P>
+    std::size_t count(const T *in, std::size_t n, const P &pred) noexcept {
+        using L = liated::lane<T>;
+        using Traits = predicate_traits<std::decay_t<P>>;
+
+        const T c = static_cast<T>(Traits::constant);
+        const auto vc = L::set1(c);
+
+        std::size_t i = 0, cnt = 0;
+        for (; i + L::width <= n; i += L::width) {
+            const unsigned m = L::template mask<Traits::kind>(L::load(in + i), vc);
+            cnt += static_cast<std::size_t>(std::popcount(keep ? m : ~m & L::full));
+        }
+        for (; i < n; ++i) {
+            cnt += static_cast<bool>(std::invoke(pred, in[i])) == keep;
+        }
+        return cnt;
+    }
+
+    /**
+    * Bit i of the result is set iff (pred(in[i]) == keep), for i < n <= 64.
+    * Every element is evaluated and nothing branches on the predicate.
+    */
+    template<bool keep, std::random_access_iterator It, class P>
+    std::uint64_t match_mask(It in, std::size_t n, const P &pred) {
+        std::uint64_t m = 0;
+        std::size_t i = 0;
+
+        if constexpr (std::contiguous_iterator<It> and compare_kernel_for<std::iter_value_t<It>, P>) {
+            using T = std::iter_value_t<It>;
+            using L = liated::lane<T>;
+            using Traits = predicate_traits<std::decay_t<P>>;
+
+            const T *src = std::to_address(in);
+            const auto vc = L::set1(static_cast<T>(Traits::constant));
+            for (; i + L::width <= n; i += L::width) {
+                const unsigned r = L::template mask<Traits::kind>(L::load(src + i), vc);
+                m |= static_cast<std::uint64_t>(keep ? r : ~r & L::full) << i;
+            }
+        }
+        for (; i < n; ++i) {
+            m |= static_cast<std::uint64_t>(static_cast<bool>(std::invoke(pred, in[i])) == keep) << i;
+        }
+        return m;
+    }
+
+    /**
+    * Packs every x in in[0, n) with (pred(x) == keep), in order, and hands them to sink chunk by chunk.
+    * A chunk is read completely before it reaches sink, so sink may write the survivors back into in (in-place).
+    * @param sink called as sink(const T *first, const T *last) for each chunk of survivors
+    */
+    template<bool keep, typename T, class P, class Sink>
+    void compact(const T *in, std::size_t n, const P &pred, Sink &&sink) {
+        constexpr std::size_t chunk = 1024;
+        alignas(64) T buf[chunk + 16];
+
+        for (std::size_t base = 0; base < n; base += chunk) {
+            const std::size_t len = std::min(chunk, n - base);
+            const T *src = in + base;
+            std::size_t k = 0, i = 0;
+
+            if constexpr (compare_kernel_for<T, P>) {
+                using Traits = predicate_traits<std::decay_t<P>>;
+                const T c = static_cast<T>(Traits::constant);
+
+#if defined(__AVX512F__)
+                using W = liated::wide_lane<T>;
+                const auto wc = W::set1(c);
+                for (; i + W::width <= len; i += W::width) {
+                    const auto x = W::load(src + i);
+                    const unsigned m = W::template mask<Traits::kind>(x, wc);
+                    const unsigned sel = keep ? m : ~m & ((1u << W::width) - 1);
+                    W::compress(buf + k, sel, x);
+                    k += static_cast<std::size_t>(std::popcount(sel));
+                }
+#endif
+                using L = liated::lane<T>;
+                const auto vc = L::set1(c);
+                for (; i + L::width <= len; i += L::width) {
+                    const auto x = L::load(src + i);
+                    const unsigned m = L::template mask<Traits::kind>(x, vc);
+                    k += liated::pack<L>(buf + k, keep ? m : ~m & L::full, x, src + i);
+                }
+            }
+
+            for (; i < len; ++i) {
+                buf[k] = src[i];
+                k += static_cast<bool>(std::invoke(pred, src[i])) == keep;
+            }
+
+            sink(static_cast<const T *>(buf), static_cast<const T *>(buf + k));
+        }
+    }
+}
+
+#endif//UNDERSCORE_CPP_SIMD_HPP
@@ -0,0 +1,420 @@
+#ifndef UNDERSCORE_CPP_STREAM_HPP
+#define UNDERSCORE_CPP_STREAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "executor.hpp"
+#include "pipeline.hpp"
+
+namespace fff::factory {
+    template<typename In>
+    struct Stream;
+}
+
+/*
+* fff::stream Reducible_TD
+*
+* Runs every stage of a fff::Pipeline on its own thread, so that a chain of stages of very different cost
+* runs at the speed of its slowest stage instead of the sum of all.
+* The stages are connected by bounded single-producer/single-consumer ring buffers :
+* a stage that gets ahead waits for room (backpressure), and the queues report how full they have been.
+*/
+namespace fff {
+
+    /**
+    * What a queue between two stages has seen.
+    * The occupancy is sampled at every 16th push.
+    */
+    struct queue_stats {
+        std::size_t capacity = 0;
+        std::size_t pushed = 0;
+        double mean_occupancy = 0;
+        std::size_t max_occupancy = 0;
+        std::size_t full_waits = 0;  // pushes that found the queue full (the consumer is the slower one)
+        std::size_t empty_waits = 0; // pops that found the queue empty (the producer is the slower one)
+    };
+
+    namespace liated {
+
+        /**
+        * Spins first, then yields, then sleeps, so that an idle stage soon stops taking a core.
+        */
+        class backoff {
+            unsigned n = 0;
+
+        public:
+            void operator()() {
+                if (++n <= 64) {
+                    return;
+                }
+                if (n <= 1024) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        };
+
+        /**
+        * A bounded lock-free ring buffer for exactly one producer thread and one consumer thread.\n
+        * The producer pushes, then closes; the consumer pops until it gets std::nullopt, or aborts to stop early.
+        * Each side keeps the other side's index in a cache of its own, and reads the shared one only when
+        * the queue looks full (or empty), so the two threads rarely touch the same cache line.
+        */
+        template<typename T>
+        class SpscQueue {
+            struct slot {
+                alignas(T) unsigned char buf[sizeof(T)];
+            };
+
+            const std::size_t cap;
+            std::unique_ptr<slot[]> slots;
+
+            // the producer's
+            alignas(cache_line) std::atomic<std::size_t> tail = 0;
+            std::size_t head_cache = 0;
+            std::atomic<std::size_t> occupancy_sum = 0;
+            std::atomic<std::size_t> occupancy_samples = 0;
+            std::atomic<std::size_t> occupancy_max = 0;
+            std::atomic<std::size_t> full_waits = 0;
+            std::atomic<bool> closed = false;
+
+            // the consumer's
+            alignas(cache_line) std::atomic<std::size_t> head = 0;
+            std::size_t tail_cache = 0;
+            std::atomic<std::size_t> empty_waits = 0;
+            std::atomic<bool> aborted = false;
+
+            T *at(std::size_t i) noexcept {
+                return std::launder(reinterpret_cast<T *>(slots[i & (cap - 1)].buf));
+            }
+
+            template<typename C>
+            static void bump(std::atomic<C> &c, C by = 1) noexcept {
+                c.store(c.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+            }
+
+        public:
+            /**
+            * @param capacity rounded up to a power of two
+            */
+            explicit SpscQueue(std::size_t capacity)
+                : cap(std::bit_ceil(std::max<std::size_t>(capacity, 2))), slots(std::make_unique<slot[]>(cap)) {}
+
+            SpscQueue(const SpscQueue &) = delete;
+            SpscQueue &operator=(const SpscQueue &) = delete;
+
+            ~SpscQueue() {
+                const std::size_t t = tail.load(std::memory_order_acquire);
+                for (std::size_t i = head.load(std::memory_order_relaxed); i != t; ++i) {
+                    at(i)->~T();
+                }
+            }
+
+            /**
+            * Waits for room, then pushes v. (the producer only)
+            * @return false if the consumer has aborted, and v was not pushed
+            */
+            template<typename U>
+            bool push(U &&v) {
+                if (aborted.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                const std::size_t t = tail.load(std::memory_order_relaxed);
+
+                if (t - head_cache == cap) {
+                    head_cache = head.load(std::memory_order_acquire);
+                    if (t - head_cache == cap) {
+                        bump(full_waits);
+                        for (backoff wait; t - head_cache == cap; wait()) {
+                            if (aborted.load(std::memory_order_acquire)) {
+                                return false;
+                            }
+                            head_cache = head.load(std::memory_order_acquire);
+                        }
+                    }
+                }
+
+                ::new (static_cast<void *>(at(t))) T(std::forward<U>(v));
+                tail.store(t + 1, std::memory_order_release);
+
+                if (t % 16 == 0) {
+                    const std::size_t occupancy = t + 1 - head.load(std::memory_order_relaxed);
+                    bump(occupancy_sum, occupancy);
+                    bump(occupancy_samples);
+                    if (occupancy > occupancy_max.load(std::memory_order_relaxed)) {
+                        occupancy_max.store(occupancy, std::memory_order_relaxed);
+                    }
+                }
+                return true;
+            }
+
+            /**
+            * No more pushes. (the producer only)
+            */
+            void close() noexcept {
+                closed.store(true, std::memory_order_release);
+            }
+
+            /**
+            * Waits for a value and pops it. (the consumer only)
+            * @return std::nullopt once the queue is closed and empty
+            */
+            auto pop() -> std::optional<T> {
+                const std::size_t h = head.load(std::memory_order_relaxed);
+
+                if (h == tail_cache) {
+                    tail_cache = tail.load(std::memory_order_acquire);
+                    if (h == tail_cache) {
+                        bump(empty_waits);
+                        for (backoff wait; h == tail_cache; wait()) {
+                            const bool done = closed.load(std::memory_order_acquire);
+                            tail_cache = tail.load(std::memory_order_acquire);
+                            if (done and h == tail_cache) {
+                                return std::nullopt;
+                            }
+                        }
+                    }
+                }
+
+                T *x = at(h);
+                std::optional<T> ret(std::move(*x));
+                x->~T();
+                head.store(h + 1, std::memory_order_release);
+                return ret;
+            }
+
+            /**
+            * No more pops; a push that waits for room gives up, and so does every push after it. (the consumer only)
+            */
+            void abort() noexcept {
+                aborted.store(true, std::memory_order_release);
+            }
+
+            [[nodiscard]] queue_stats stats() const noexcept {
+                queue_stats ret;
+                ret.capacity = cap;
+                ret.pushed = tail.load(std::memory_order_relaxed);
+                if (const std::size_t samples = occupancy_samples.load(std::memory_order_relaxed); samples != 0) {
+                    ret.mean_occupancy = static_cast<double>(occupancy_sum.load(std::memory_order_relaxed)) / static_cast<double>(samples);
+                }
+                ret.max_occupancy = occupancy_max.load(std::memory_order_relaxed);
+                ret.full_waits = full_waits.load(std::memory_order_relaxed);
+                ret.empty_waits = empty_waits.load(std::memory_order_relaxed);
+                return ret;
+            }
+        };
+
+        /**
+        * The types that the stages of a pipeline make, one after another, from an In.
+        */
+        template<typename In, class Stages>
+        struct stream_types;
+
+        template<typename In>
+        struct stream_types<In, std::tuple<>> {
+            using type = std::tuple<>;
+        };
+
+        template<typename In, class F, class ...Fs>
+        struct stream_types<In, std::tuple<F, Fs...>> {
+            using type = typename batch_cons<
+                feed_result_t<F, In>,
+                typename stream_types<feed_result_t<F, In>, std::tuple<Fs...>>::type
+            >::type;
+        };
+
+        template<class Types, std::size_t ...I>
+        auto stream_queues(std::index_sequence<I...>) -> std::tuple<std::unique_ptr<SpscQueue<std::tuple_element_t<I, Types>>>...>;
+    }
+
+    /**
+    * A fff::Pipeline running on one thread per stage, fed by push() and drained by pop().\n
+    * To put several stages on one thread, nest them : fff::pipeline | decode | (fff::pipeline | enrich | score) | emit
+    * runs on three threads. If the last stage returns void there is nothing to pop.
+    * The stages run on threads of their own, not on fff::executor::global(), since they wait for each other.
+    * @example auto s = fff::stream<std::string>(fff::pipeline | decode | enrich | score, 1024);
+    * std::jthread feeder([&] {for (auto &line : lines) s.push(line); s.close();});
+    * while (auto score = s.pop()) {...}
+    * s.wait();
+    */
+    template<typename In, class P>
+    class StreamRunner {
+        friend factory::Stream<In>;
+
+        using stages_t = decltype(liated::PipelineStages::of(std::declval<const P &>()));
+        using types_t = typename liated::batch_cons<In, typename liated::stream_types<In, stages_t>::type>::type;
+
+        constexpr static std::size_t stage_count = std::tuple_size_v<stages_t>;
+
+    public:
+        using output_type = std::tuple_element_t<stage_count, types_t>;
+
+    private:
+        constexpr static bool has_output = not std::is_void_v<output_type>;
+        constexpr static std::size_t queue_count = has_output ? stage_count + 1 : stage_count;
+
+        stages_t stages;
+        decltype(liated::stream_queues<types_t>(std::make_index_sequence<queue_count>())) queues;
+        std::vector<std::thread> threads;
+
+        std::mutex error_m;
+        std::exception_ptr error;
+        bool closed = false;
+
+        template<std::size_t I>
+        void run_stage() {
+            auto &in = *std::get<I>(queues);
+            const auto &f = std::get<I>(stages);
+
+            try {
+                while (auto x = in.pop()) {
+                    if constexpr (I + 1 < queue_count) {
+                        if (not std::get<I + 1>(queues)->push(liated::feed(f, std::move(*x)))) {
+                            in.abort();
+                            break;
+                        }
+                    } else {
+                        liated::feed(f, std::move(*x));
+                    }
+                }
+            } catch (...) {
+                {
+                    std::lock_guard lk(error_m);
+                    if (not error) {
+                        error = std::current_exception();
+                    }
+                }
+                in.abort();
+            }
+
+            if constexpr (I + 1 < queue_count) {
+                std::get<I + 1>(queues)->close();
+            }
+        }
+
+        StreamRunner(const P &p, std::size_t capacity) : stages(liated::PipelineStages::of(p)) {
+            [this, capacity]<std::size_t ...I>(std::index_sequence<I...>) {
+                ((std::get<I>(queues) = std::make_unique<typename std::tuple_element_t<I, decltype(queues)>::element_type>(capacity)), ...);
+            }(std::make_index_sequence<queue_count>());
+
+            threads.reserve(stage_count);
+            [this]<std::size_t ...S>(std::index_sequence<S...>) {
+                (threads.emplace_back([this] {
+                    run_stage<S>();
+                }), ...);
+            }(std::make_index_sequence<stage_count>());
+        }
+
+    public:
+        StreamRunner(const StreamRunner &) = delete;
+        StreamRunner &operator=(const StreamRunner &) = delete;
+
+        /**
+        * Closes the input, stops taking the output, and joins the stages. It never throws.
+        */
+        ~StreamRunner() {
+            close();
+            if constexpr (has_output) {
+                std::get<queue_count - 1>(queues)->abort();
+            }
+            for (auto &th : threads) {
+                if (th.joinable()) {
+                    th.join();
+                }
+            }
+        }
+
+        /**
+        * Feeds x to the first stage, waiting while its queue is full. Call push() and close() from one thread.
+        * @return false if the stream has stopped (a stage threw), and x was dropped
+        */
+        bool push(In x) {
+            return std::get<0>(queues)->push(std::move(x));
+        }
+
+        /**
+        * No more input; the stages finish what they have, then stop.
+        */
+        void close() noexcept {
+            if (not closed) {
+                closed = true;
+                std::get<0>(queues)->close();
+            }
+        }
+
+        /**
+        * The next result, waiting for it. Call pop() from one thread.
+        * @return std::nullopt once the stream is closed and drained
+        */
+        auto pop() -> std::optional<output_type> requires has_output {
+            return std::get<queue_count - 1>(queues)->pop();
+        }
+
+        /**
+        * Closes the input and joins the stages. With an output, pop() it to the end first.
+        * @throw the first exception that a stage threw
+        */
+        void wait() {
+            close();
+            for (auto &th : threads) {
+                if (th.joinable()) {
+                    th.join();
+                }
+            }
+
+            std::exception_ptr e;
+            {
+                std::lock_guard lk(error_m);
+                std::swap(e, error);
+            }
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+
+        /**
+        * One entry for every queue : the input of every stage, then the output if there is one.
+        */
+        [[nodiscard]] auto stats() const -> std::vector<queue_stats> {
+            std::vector<queue_stats> ret;
+            std::apply([&ret](const auto &...q) {
+                (ret.push_back(q->stats()), ...);
+            }, queues);
+            return ret;
+        }
+    };
+
+    namespace factory {
+        template<typename In>
+        struct Stream {
+            /**
+            * @param capacity the room of every queue (rounded up to a power of two)
+            */
+            template<class F, class ...Fp>
+            auto operator()(const Pipeline<F, Fp...> &p, std::size_t capacity = 1024) const
+                -> StreamRunner<In, Pipeline<F, Fp...>>
+            {
+                return StreamRunner<In, Pipeline<F, Fp...>>(p, capacity);
+            }
+        };
+    }
+
+    template<typename In>
+    constexpr inline factory::Stream<In> stream;
+}
+
+#endif//UNDERSCORE_CPP_STREAM_HPP
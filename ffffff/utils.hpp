@@ -1,11 +1,19 @@
 #ifndef UNDERSCORE_CPP_UTILS_HPP
 #define UNDERSCORE_CPP_UTILS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
 #include <type_traits>
 #include <functional>
-#include <iostream>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
 
+#include "executor.hpp"
 #include "interfaces.hpp"
 #include "tmf.hpp"
 
@@ -81,41 +89,238 @@ namespace fff {
 */
 namespace fff {
 
+    namespace liated {
+        template<typename F, typename ...Args>
+        struct Once_TD {
+            using type = const std::remove_cvref_t<std::invoke_result_t<const F &>> &;
+        };
+    }
+
+    /**
+    * The tag of an eager fff::once, see fff::warm_up.
+    */
+    struct eager_t {
+        explicit eager_t() = default;
+    };
+
+    constexpr inline eager_t eager{};
+
+    namespace liated {
+
+        /**
+        * Every live eager Once_f, with the function that warms it up.
+        * A warm-up task names its once by id, and runs it only if it is still registered;
+        * remove() waits for the warm-ups that are running it, so a once never goes away under its task.
+        * Never destroyed, so that the static onces may still leave it at exit.
+        */
+        class WarmUpRegistry {
+            struct entry {
+                const void *self;
+                void (*run)(const void *);
+                std::uint64_t id;
+                std::size_t running = 0;
+            };
+
+            std::mutex m;
+            std::condition_variable idle;
+            std::vector<entry> entries;
+            std::uint64_t next_id = 0;
+
+            auto find(std::uint64_t id) noexcept {
+                return std::find_if(entries.begin(), entries.end(), [id](const entry &e) {return e.id == id;});
+            }
+
+        public:
+            void add(const void *self, void (*run)(const void *)) {
+                std::lock_guard lk(m);
+                entries.push_back({self, run, next_id++});
+            }
+
+            void remove(const void *self) noexcept {
+                std::unique_lock lk(m);
+                const auto it = std::find_if(entries.begin(), entries.end(), [self](const entry &e) {return e.self == self;});
+                if (it == entries.end()) {
+                    return;
+                }
+                const std::uint64_t id = it->id;
+                idle.wait(lk, [&] {return find(id)->running == 0;});
+                entries.erase(find(id));
+            }
+
+            /**
+            * the ids of the onces registered now
+            */
+            std::vector<std::uint64_t> ids() {
+                std::lock_guard lk(m);
+                std::vector<std::uint64_t> ret;
+                ret.reserve(entries.size());
+                for (const auto &e : entries) {
+                    ret.push_back(e.id);
+                }
+                return ret;
+            }
+
+            /**
+            * Warms up the once id, unless it has left the registry.
+            */
+            void warm(std::uint64_t id) noexcept {
+                entry e;
+                {
+                    std::lock_guard lk(m);
+                    const auto it = find(id);
+                    if (it == entries.end()) {
+                        return;
+                    }
+                    ++it->running;
+                    e = *it;
+                }
+                e.run(e.self);
+                {
+                    std::lock_guard lk(m);
+                    --find(id)->running;
+                }
+                idle.notify_all();
+            }
+
+            static WarmUpRegistry &global() {
+                static auto *instance = new WarmUpRegistry();
+                return *instance;
+            }
+        };
+    }
+
     template<typename F>
     class Once_f;
 
+    /**
+    * Calls f on the first call only, and returns what it returned on every call, from any thread.\n
+    * After the first call, a call is one acquire load. Concurrent first calls run f once;
+    * the others wait (on the state itself, so a futex on Linux) until the result is there.
+    * If f throws, the exception goes to its caller and the next call tries again.
+    * The result is returned by const reference, and lives as long as the Once_f.
+    * @example auto config = fff::once([] {return parse_config();}); config().port;
+    */
     template<nonvoid_invocable F>
-    class Once_f<F> : public callable_i<F, Once_f<F>, std::invoke_result> {
-        friend callable_i<F, Once_f<F>, std::invoke_result>;
+    class Once_f<F> : public callable_i<F, Once_f<F>, liated::Once_TD> {
+        friend callable_i<F, Once_f<F>, liated::Once_TD>;
         friend factory::Once;
 
-        [[no_unique_address]]   F                                   f;
-        [[no_unique_address]]   mutable std::invoke_result_t<F>     memo;
-                                mutable bool                        flag;
+        using R = std::remove_cvref_t<std::invoke_result_t<const F &>>;
+
+        enum state_t : unsigned char { empty, running, ready };
+
+        [[no_unique_address]]   F                               f;
+                                mutable std::atomic<state_t>    state;
+                                bool                            eager = false;
+        alignas(R)              mutable unsigned char           storage[sizeof(R)];
 
         constexpr explicit Once_f(const F &f) noexcept
-            : f(f),             flag(false) {}
+            : f(f),             state(empty) {}
         constexpr explicit Once_f(F &&f) noexcept
-            : f(std::move(f)),  flag(false) {}
+            : f(std::move(f)),  state(empty) {}
+
+        template<typename G>
+        Once_f(eager_t, G &&g)
+            : f(std::forward<G>(g)), state(empty), eager(true) {
+            liated::WarmUpRegistry::global().add(this, &Once_f::warm);
+        }
+
+        const R &value() const noexcept {
+            return *std::launder(reinterpret_cast<const R *>(storage));
+        }
+
+        /**
+        * Runs f and stores its result, if nobody has run it and nobody is running it.
+        * @return ready if this call ran f, or the state it found otherwise
+        */
+        state_t try_run() const noexcept(std::is_nothrow_invocable_r_v<R, const F &>) {
+            state_t s = empty;
+            if (not state.compare_exchange_strong(s, running, std::memory_order_acquire)) {
+                return s;
+            }
+
+            if constexpr (std::is_nothrow_invocable_r_v<R, const F &>) {
+                ::new (static_cast<void *>(storage)) R(std::invoke(f));
+            } else {
+                try {
+                    ::new (static_cast<void *>(storage)) R(std::invoke(f));
+                } catch (...) {
+                    state.store(empty, std::memory_order_release);
+                    state.notify_all();
+                    throw;
+                }
+            }
+            state.store(ready, std::memory_order_release);
+            state.notify_all();
+            return ready;
+        }
+
+        /**
+        * The first call, or a call that raced with it.
+        */
+        [[gnu::noinline]] const R &slow_path() const noexcept(std::is_nothrow_invocable_r_v<R, const F &>) {
+            while (try_run() != ready) {
+                state.wait(running, std::memory_order_acquire);
+            }
+            return value();
+        }
+
+        /**
+        * What fff::warm_up runs : f, unless it has run or is running. An exception is left for the next caller.
+        */
+        static void warm(const void *self) noexcept {
+            try {
+                static_cast<const Once_f *>(self)->try_run();
+            } catch (...) {}
+        }
 
         template<similar<Once_f<F>> Self>
-        constexpr static auto call_impl(Self &&self)
-            noexcept(std::is_nothrow_invocable_v<F>)
-                -> std::invoke_result_t<F>
+        static auto call_impl(Self &&self)
+            noexcept(std::is_nothrow_invocable_r_v<R, const F &>)
+                -> const R &
         {
-            if constexpr (debug) {
-                std::cout << (not std::is_lvalue_reference_v<Self> ? "Rvalue called!\n" : "Lvalue called!\n");
-                std::cout << (not std::is_lvalue_reference_v<decltype((std::forward<Self>(self).f))>
-                    ? "Rvalue caught!\n" : "Lvalue caught!\n");
+            if (self.state.load(std::memory_order_acquire) == ready) [[likely]] {
+                return self.value();
+            }
+            return self.slow_path();
+        }
+
+    public:
+        /**
+        * Copies f, and the result too if other has one.
+        */
+        Once_f(const Once_f &other) : f(other.f), state(empty), eager(other.eager) {
+            if (other.state.load(std::memory_order_acquire) == ready) {
+                ::new (static_cast<void *>(storage)) R(other.value());
+                state.store(ready, std::memory_order_relaxed);
             }
-            if (self.flag) {
-                return self.memo;
+            if (eager) {
+                liated::WarmUpRegistry::global().add(this, &Once_f::warm);
             }
-            self.flag = true;
-            return self.memo = std::invoke(std::forward<Self>(self).f);
         }
 
-        constexpr static bool debug = true;
+        Once_f(Once_f &&other) noexcept(std::is_nothrow_move_constructible_v<F> and std::is_nothrow_move_constructible_v<R>)
+            : f(std::move(other.f)), state(empty), eager(other.eager) {
+            if (other.state.load(std::memory_order_acquire) == ready) {
+                ::new (static_cast<void *>(storage)) R(std::move(*std::launder(reinterpret_cast<R *>(other.storage))));
+                state.store(ready, std::memory_order_relaxed);
+            }
+            if (eager) {
+                liated::WarmUpRegistry::global().add(this, &Once_f::warm);
+            }
+        }
+
+        Once_f &operator=(const Once_f &) = delete;
+        Once_f &operator=(Once_f &&) = delete;
+
+        ~Once_f() {
+            if (eager) {
+                liated::WarmUpRegistry::global().remove(this);
+            }
+            if (state.load(std::memory_order_acquire) == ready) {
+                std::launder(reinterpret_cast<R *>(storage))->~R();
+            }
+        }
     };
 
     namespace factory {
@@ -126,47 +331,151 @@ namespace fff {
             {
                 return Once_f<std::decay_t<F>>{std::forward<F>(f)};
             }
+
+            /**
+            * An eager once : fff::warm_up runs it in the background, before anyone calls it.
+            * @example inline const auto table = fff::once(fff::eager, [] {return build_table();});
+            */
+            template<std::invocable F>
+            auto operator()(eager_t, F &&f) const
+                -> Once_f<std::decay_t<F>>
+            {
+                return Once_f<std::decay_t<F>>{eager, std::forward<F>(f)};
+            }
         };
     }
 
     constexpr inline factory::Once once;
+
+    /**
+    * Starts every eager fff::once that has not run yet, concurrently, on ex, and returns without waiting.
+    * A caller that gets to a once before its warm-up does runs it itself; a caller that gets to it while it runs waits for it.
+    * A once destroyed before its task runs is skipped, and destroying a once waits for a warm-up that is running it.
+    * @return the number of eager onces it queued
+    * @example int main() { fff::warm_up(); serve(); }
+    */
+    inline std::size_t warm_up(executor &ex = executor::global()) {
+        const auto ids = liated::WarmUpRegistry::global().ids();
+        for (const auto id : ids) {
+            ex.submit([id] { liated::WarmUpRegistry::global().warm(id); });
+        }
+        return ids.size();
+    }
+}
+
+/* fff::ShardedCounter Reducible_TD */
+namespace fff {
+
+    /**
+    * A counter that many threads can bump at once without fighting over one cache line.\n
+    * Every thread adds to its own padded cell (threads take the cells in turn), and get() sums the cells.
+    * So add() is one uncontended relaxed atomic add, and get() costs one load per cell.
+    */
+    class ShardedCounter {
+        struct alignas(liated::cache_line) cell {
+            std::atomic<std::int64_t> n = 0;
+        };
+
+        std::size_t mask;
+        std::unique_ptr<cell[]> cells;
+
+        static std::size_t thread_slot() noexcept {
+            static std::atomic<std::size_t> next = 0;
+            thread_local const std::size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+    public:
+        /**
+        * @param shards the number of cells, rounded up to a power of two; one per hardware thread by default
+        */
+        explicit ShardedCounter(std::size_t shards = liated::default_concurrency())
+            : mask(std::bit_ceil(std::max<std::size_t>(1, shards)) - 1), cells(std::make_unique<cell[]>(mask + 1)) {}
+
+        /**
+        * Starts from the total of other.
+        */
+        ShardedCounter(const ShardedCounter &other)
+            : mask(other.mask), cells(std::make_unique<cell[]>(mask + 1)) {
+            cells[0].n.store(other.get(), std::memory_order_relaxed);
+        }
+
+        ShardedCounter &operator=(const ShardedCounter &other) {
+            if (this != &other) {
+                const std::int64_t total = other.get();
+                reset();
+                cells[0].n.store(total, std::memory_order_relaxed);
+            }
+            return *this;
+        }
+
+        void add(std::int64_t d) noexcept {
+            cells[thread_slot() & mask].n.fetch_add(d, std::memory_order_relaxed);
+        }
+
+        void inc() noexcept {
+            add(1);
+        }
+
+        /**
+        * The sum of the cells. Adds that race with it may or may not be counted.
+        */
+        [[nodiscard]] std::int64_t get() const noexcept {
+            std::int64_t total = 0;
+            for (std::size_t i = 0; i <= mask; ++i) {
+                total += cells[i].n.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        void reset() noexcept {
+            for (std::size_t i = 0; i <= mask; ++i) {
+                cells[i].n.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
 }
 
 /* fff::Count_f Reducible_TD */
 namespace fff {
 
+    /**
+    * Calls f, and counts the calls, from any number of threads (see fff::ShardedCounter).
+    * @example auto g = fff::count(f); g(1); g(2); g.get_count() == 2
+    */
     template<class F>
     class Count_f {
-        friend class CountFactory;
+        friend factory::Count;
 
         [[no_unique_address]] F f;
-        mutable int cnt;
+        mutable ShardedCounter cnt;
 
-        constexpr explicit Count_f(const F &f) noexcept : f(f), cnt(0) {}
-        constexpr explicit Count_f(F &&f) noexcept : f(std::move(f)), cnt(0) {}
+        explicit Count_f(const F &f) : f(f) {}
+        explicit Count_f(F &&f) : f(std::move(f)) {}
 
     public:
         template<class ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args ...args) const
+            requires std::invocable<const F &, Args...>
+        auto operator()(Args &&...args) const
             noexcept(noexcept(std::invoke(f, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+                -> std::invoke_result_t<const F &, Args...>
         {
-            ++cnt;
+            cnt.inc();
             return std::invoke(f, std::forward<Args>(args)...);
         }
-        constexpr int get_count() const noexcept {
-            return cnt;
+
+        [[nodiscard]] std::int64_t get_count() const noexcept {
+            return cnt.get();
         }
     };
 
     namespace factory {
         struct Count {
             template<class F>
-            constexpr auto operator()(F &&f) const noexcept
-                -> Count_f<F>
+            auto operator()(F &&f) const
+                -> Count_f<std::decay_t<F>>
             {
-                return Count_f<F>(std::forward<F>(f));
+                return Count_f<std::decay_t<F>>(std::forward<F>(f));
             }
         };
     }
@@ -178,39 +487,150 @@ namespace fff {
 * fff::Fly Reducible_TD
 */
 namespace fff {
-    template<class F>
+
+    /**
+    * How a fff::Fly keeps its function object.
+    */
+    namespace fly_storage {
+
+        /**
+        * On the heap, one block per Fly : a copy allocates and copies f.
+        * f is not part of the Fly, so a const Fly can still call a non-const f (a mutable lambda, ...).
+        */
+        struct heap {
+            template<class F>
+            class storage {
+                std::unique_ptr<F> p;
+
+            public:
+                explicit storage(const F &f) : p(std::make_unique<F>(f)) {}
+                explicit storage(F &&f) : p(std::make_unique<F>(std::move(f))) {}
+
+                storage(const storage &other) : p(std::make_unique<F>(*other.p)) {}
+                storage(storage &&) noexcept = default;
+                storage &operator=(const storage &other) {
+                    p = std::make_unique<F>(*other.p);
+                    return *this;
+                }
+                storage &operator=(storage &&) noexcept = default;
+
+                F &get() const noexcept {
+                    return *p;
+                }
+            };
+        };
+
+        /**
+        * Inside the Fly itself if f is at most N bytes (and moves without throwing), on the heap otherwise.
+        * A copy of a small f is a plain copy, with no allocation.
+        */
+        template<std::size_t N = 3 * sizeof(void *)>
+        struct small {
+            template<class F>
+            constexpr static bool fits = sizeof(F) <= N and std::is_nothrow_move_constructible_v<F>;
+
+            template<class F>
+            class inline_storage {
+                [[no_unique_address]] F f;
+
+            public:
+                explicit inline_storage(const F &f) : f(f) {}
+                explicit inline_storage(F &&f) noexcept : f(std::move(f)) {}
+
+                const F &get() const noexcept {
+                    return f;
+                }
+                F &get() noexcept {
+                    return f;
+                }
+            };
+
+            template<class F>
+            using storage = std::conditional_t<fits<F>, inline_storage<F>, heap::storage<F>>;
+        };
+
+        /**
+        * One immutable f on the heap, shared by every copy through a reference count : a copy allocates nothing.
+        * A call that needs a non-const f (a mutable lambda, ...) first gives this Fly its own copy, if f is shared (copy-on-write).
+        */
+        struct shared {
+            template<class F>
+            class storage {
+                std::shared_ptr<F> p;
+
+            public:
+                explicit storage(const F &f) : p(std::make_shared<F>(f)) {}
+                explicit storage(F &&f) : p(std::make_shared<F>(std::move(f))) {}
+
+                const F &get() const noexcept {
+                    return *p;
+                }
+                F &get() {
+                    if (p.use_count() != 1) {
+                        p = std::make_shared<F>(std::as_const(*p));
+                    }
+                    return *p;
+                }
+            };
+        };
+    }
+
+    /**
+    * A function object kept out of line, so that the Fly itself stays the same small size whatever F is.
+    * @tparam Storage fly_storage::heap (default), fly_storage::small\<N> or fly_storage::shared
+    * @example auto cb = fff::fly(fff::fly_storage::shared(), big_stateful_callback); queue.push(cb);
+    */
+    template<class F, class Storage = fly_storage::heap>
     class Fly {
-        std::unique_ptr<F> p;
+        using stored = typename Storage::template storage<F>;
 
-    public:
-        explicit Fly(const F &f) : p(new F(f)) {}
-        explicit Fly(F &&f) : p(new F(std::move(f))) {}
+        /**
+        * How a const Fly sees f : F & with fly_storage::heap, const F & otherwise
+        */
+        using const_f = decltype(std::declval<const stored &>().get());
 
-        Fly(const Fly &fly) : p(new F(*fly.p)) {}
-        Fly(Fly &&fly) noexcept = default;
-        Fly &operator=(const Fly &fly) {
-            p = std::make_unique<F>(*fly.p);
-            return *this;
-        }
-        Fly &operator=(Fly &&) noexcept = default;
+        stored s;
+
+    public:
+        explicit Fly(const F &f) : s(f) {}
+        explicit Fly(F &&f) : s(std::move(f)) {}
 
         template<class ...Args>
-            requires std::invocable<F, Args...>
+            requires std::invocable<const_f, Args...>
         auto operator()(Args &&...args) const
-            noexcept(noexcept(std::invoke(*p, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+            noexcept(noexcept(std::invoke(s.get(), std::forward<Args>(args)...)))
+                -> std::invoke_result_t<const_f, Args...>
         {
-            return std::invoke(*p, std::forward<Args>(args)...);
+            return std::invoke(s.get(), std::forward<Args>(args)...);
         }
 
+        /**
+        * For an f that can only be called as non-const; with fly_storage::shared, this is where f is copied on write.
+        */
+        template<class ...Args>
+            requires (not std::invocable<const_f, Args...>) and std::invocable<F &, Args...>
+        auto operator()(Args &&...args)
+            noexcept(noexcept(std::invoke(s.get(), std::forward<Args>(args)...)))
+                -> std::invoke_result_t<F &, Args...>
+        {
+            return std::invoke(s.get(), std::forward<Args>(args)...);
+        }
     };
 
     struct FlyFactory {
         template<class F>
-        constexpr auto operator()(F &&f) const noexcept -> Fly<std::decay_t<F>> {
+        constexpr auto operator()(F &&f) const -> Fly<std::decay_t<F>> {
             return Fly<std::decay_t<F>>(std::forward<F>(f));
         }
+
+        template<class Storage, class F>
+            requires requires { typename Storage::template storage<std::decay_t<F>>; }
+        constexpr auto operator()(Storage, F &&f) const -> Fly<std::decay_t<F>, Storage> {
+            return Fly<std::decay_t<F>, Storage>(std::forward<F>(f));
+        }
     };
+
+    constexpr inline FlyFactory fly;
 }
 
 namespace fff {
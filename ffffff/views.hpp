@@ -0,0 +1,299 @@
+#ifndef UNDERSCORE_CPP_VIEWS_HPP
+#define UNDERSCORE_CPP_VIEWS_HPP
+
+#include <functional>
+#include <ranges>
+#include <tuple>
+#include <vector>
+
+#include "tmf.hpp"
+
+/*
+* fff::views Reducible_TD
+*
+* Lazy versions of fff::Map, fff::Filter and fff::Reject.
+* A view stage does not build any container; it only remembers what to do.
+* All stages of a chain are fused and run in ONE pass when the chain is collected.
+*
+* @example auto got = v | views::map(f) | views::filter(p) | views::collect;
+* @example auto g = fff::pipeline | views::map(f) | views::reject(p) | views::to<std::list>;
+*/
+namespace fff::views {
+
+    template<std::ranges::view V, class ...Stages>
+    class Lazy;
+
+    namespace liated {
+        template<typename T>
+        struct is_lazy : std::false_type {};
+
+        template<std::ranges::view V, class ...Stages>
+        struct is_lazy<Lazy<V, Stages...>> : std::true_type {};
+    }
+
+    /**
+    * determines whether T is a (not-yet-evaluated) Lazy chain
+    */
+    template<typename T>
+    concept lazy = liated::is_lazy<std::remove_cvref_t<T>>::value;
+
+    /**
+    * determines whether a view stage can be applied to T
+    */
+    template<typename T>
+    concept viewable = lazy<T> or std::ranges::viewable_range<T>;
+
+    /**
+    * A map stage : sends f(t) to the next stage.
+    */
+    template<class F>
+    class Map_f {
+        [[no_unique_address]] F f;
+
+    public:
+        constexpr explicit Map_f(const F &f) noexcept : f(f) {}
+        constexpr explicit Map_f(F &&f) noexcept : f(std::move(f)) {}
+
+        template<typename T>
+        using result_t = std::invoke_result_t<const F &, T>;
+
+        constexpr static bool size_preserving = true;
+
+        template<typename T, class Next>
+        constexpr void step(T &&t, Next &&next) const
+            noexcept(noexcept(std::invoke(next, std::invoke(f, std::forward<T>(t)))))
+        {
+            std::invoke(next, std::invoke(f, std::forward<T>(t)));
+        }
+
+        template<class R>
+            requires viewable<R>
+        constexpr auto operator()(R &&r) const &;
+
+        template<class R>
+            requires viewable<R>
+        constexpr auto operator()(R &&r) &&;
+    };
+
+    /**
+    * A filter stage : sends t to the next stage IFF pred(t) is true.
+    * @tparam keep false if the stage works as a reject stage
+    */
+    template<class P, bool keep = true>
+    class Filter_f {
+        [[no_unique_address]] P pred;
+
+    public:
+        constexpr explicit Filter_f(const P &pred) noexcept : pred(pred) {}
+        constexpr explicit Filter_f(P &&pred) noexcept : pred(std::move(pred)) {}
+
+        template<typename T>
+        using result_t = T;
+
+        constexpr static bool size_preserving = false;
+
+        template<typename T, class Next>
+        constexpr void step(T &&t, Next &&next) const
+            noexcept(noexcept(std::invoke(pred, t)) and noexcept(std::invoke(next, std::forward<T>(t))))
+        {
+            if (static_cast<bool>(std::invoke(pred, t)) == keep) {
+                std::invoke(next, std::forward<T>(t));
+            }
+        }
+
+        template<class R>
+            requires viewable<R>
+        constexpr auto operator()(R &&r) const &;
+
+        template<class R>
+            requires viewable<R>
+        constexpr auto operator()(R &&r) &&;
+    };
+
+    template<class P>
+    using Reject_f = Filter_f<P, false>;
+
+    namespace liated {
+        template<typename T, class ...Stages>
+        struct stage_result;
+
+        template<typename T>
+        struct stage_result<T> {
+            using type = T;
+        };
+
+        template<typename T, class S, class ...Stages>
+        struct stage_result<T, S, Stages...> {
+            using type = typename stage_result<typename S::template result_t<T>, Stages...>::type;
+        };
+    }
+
+    /**
+    * A lazy, not-yet-evaluated chain of stages over a range.
+    * Nothing is evaluated until for_each() (or a collector) is called.
+    * @tparam V std::views::all_t of the base range; refers to an lvalue base, owns an rvalue base
+    * @tparam Stages Map_f, Filter_f, ...
+    */
+    template<std::ranges::view V, class ...Stages>
+    class Lazy {
+        template<std::ranges::view W, class ...Ss>
+        friend class Lazy;
+
+        V base;
+        [[no_unique_address]] std::tuple<Stages...> stages;
+
+        template<std::size_t I, class Sink, typename T>
+        constexpr void push(Sink &sink, T &&t) const {
+            if constexpr (I == sizeof...(Stages)) {
+                std::invoke(sink, std::forward<T>(t));
+            } else {
+                std::get<I>(stages).step(std::forward<T>(t), [this, &sink](auto &&u) {
+                    push<I + 1>(sink, std::forward<decltype(u)>(u));
+                });
+            }
+        }
+
+    public:
+        using value_type = std::remove_cvref_t<
+            typename liated::stage_result<std::ranges::range_reference_t<const V>, Stages...>::type>;
+
+        /**
+        * true if every element of the base range reaches the end of the chain
+        */
+        constexpr static bool size_preserving = (Stages::size_preserving and ...);
+
+        constexpr Lazy(V base, std::tuple<Stages...> stages) noexcept
+            : base(std::move(base)), stages(std::move(stages)) {}
+
+        template<class S>
+        constexpr auto append(S &&s) const & -> Lazy<V, Stages..., std::decay_t<S>> {
+            return {base, std::tuple_cat(stages, std::make_tuple(std::forward<S>(s)))};
+        }
+
+        template<class S>
+        constexpr auto append(S &&s) && -> Lazy<V, Stages..., std::decay_t<S>> {
+            return {std::move(base), std::tuple_cat(std::move(stages), std::make_tuple(std::forward<S>(s)))};
+        }
+
+        /**
+        * Runs the whole chain in one pass.
+        * @param sink called with every element that survives the chain
+        */
+        template<class Sink>
+        constexpr void for_each(Sink &&sink) const {
+            for (auto &&t : base) {
+                push<0>(sink, std::forward<decltype(t)>(t));
+            }
+        }
+
+        constexpr auto base_size() const noexcept requires std::ranges::sized_range<const V> {
+            return std::ranges::size(base);
+        }
+    };
+
+    template<class F>
+    template<class R>
+        requires viewable<R>
+    constexpr auto Map_f<F>::operator()(R &&r) const & {
+        if constexpr (lazy<R>) {
+            return std::forward<R>(r).append(*this);
+        } else {
+            return Lazy<std::views::all_t<R>, Map_f>{std::views::all(std::forward<R>(r)), std::make_tuple(*this)};
+        }
+    }
+
+    template<class F>
+    template<class R>
+        requires viewable<R>
+    constexpr auto Map_f<F>::operator()(R &&r) && {
+        if constexpr (lazy<R>) {
+            return std::forward<R>(r).append(std::move(*this));
+        } else {
+            return Lazy<std::views::all_t<R>, Map_f>{std::views::all(std::forward<R>(r)), std::make_tuple(std::move(*this))};
+        }
+    }
+
+    template<class P, bool keep>
+    template<class R>
+        requires viewable<R>
+    constexpr auto Filter_f<P, keep>::operator()(R &&r) const & {
+        if constexpr (lazy<R>) {
+            return std::forward<R>(r).append(*this);
+        } else {
+            return Lazy<std::views::all_t<R>, Filter_f>{std::views::all(std::forward<R>(r)), std::make_tuple(*this)};
+        }
+    }
+
+    template<class P, bool keep>
+    template<class R>
+        requires viewable<R>
+    constexpr auto Filter_f<P, keep>::operator()(R &&r) && {
+        if constexpr (lazy<R>) {
+            return std::forward<R>(r).append(std::move(*this));
+        } else {
+            return Lazy<std::views::all_t<R>, Filter_f>{std::views::all(std::forward<R>(r)), std::make_tuple(std::move(*this))};
+        }
+    }
+
+    /**
+    * The collector : evaluates a Lazy chain and makes a container of type C.
+    * @tparam C any std::(container) template, std::vector by default
+    */
+    template<template<class...> class C>
+    struct To_f {
+        template<lazy L>
+        constexpr auto operator()(L &&l) const
+            -> C<typename std::remove_cvref_t<L>::value_type>
+        {
+            using T = typename std::remove_cvref_t<L>::value_type;
+            C<T> ret;
+
+            if constexpr (std::remove_cvref_t<L>::size_preserving
+                          and requires (std::size_t n) { ret.reserve(n); l.base_size(); }) {
+                ret.reserve(l.base_size());
+            }
+
+            l.for_each([&ret](auto &&t) {
+                if constexpr (requires { ret.push_back(std::forward<decltype(t)>(t)); }) {
+                    ret.push_back(std::forward<decltype(t)>(t));
+                } else {
+                    ret.insert(std::forward<decltype(t)>(t));
+                }
+            });
+
+            return ret;
+        }
+    };
+
+    struct MapFactory {
+        template<class F>
+        constexpr auto operator()(F &&f) const noexcept -> Map_f<std::decay_t<F>> {
+            return Map_f<std::decay_t<F>>{std::forward<F>(f)};
+        }
+    };
+
+    struct FilterFactory {
+        template<class P>
+        constexpr auto operator()(P &&pred) const noexcept -> Filter_f<std::decay_t<P>> {
+            return Filter_f<std::decay_t<P>>{std::forward<P>(pred)};
+        }
+    };
+
+    struct RejectFactory {
+        template<class P>
+        constexpr auto operator()(P &&pred) const noexcept -> Reject_f<std::decay_t<P>> {
+            return Reject_f<std::decay_t<P>>{std::forward<P>(pred)};
+        }
+    };
+
+    constexpr inline MapFactory map;
+    constexpr inline FilterFactory filter;
+    constexpr inline RejectFactory reject;
+
+    template<template<class...> class C>
+    constexpr inline To_f<C> to;
+
+    constexpr inline To_f<std::vector> collect;
+}
+
+#endif//UNDERSCORE_CPP_VIEWS_HPP
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <memory>
+#include <memory_resource>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ffffff/package.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* An allocator that counts its allocations.
+*/
+template<typename T>
+struct counting {
+    using value_type = T;
+    inline static int allocations = 0;
+
+    counting() = default;
+    template<typename U>
+    counting(const counting<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        ++allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting<U> &) const noexcept {
+        return true;
+    }
+};
+
+template<class A, class B>
+bool same_elements(const A &a, const B &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+int main() {
+    std::vector<int> v(20'000);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>(i * 7 % 1000);
+    }
+    const auto by3 = [](int x) {return x % 3 == 0;};
+    const auto plus7 = fff::static_r_bind<7>(std::plus<>());
+
+    // every result allocates from the arena, which cannot fall back to the heap
+    static std::byte buf[1 << 20];
+    std::pmr::monotonic_buffer_resource arena(buf, sizeof buf, std::pmr::null_memory_resource());
+
+    auto a = fff::map(v, plus7, &arena);
+    static_assert(std::is_same_v<decltype(a), std::pmr::vector<int>>);
+    CHECK(same_elements(a, fff::map(v, plus7)));
+
+    auto b = fff::filter(v, by3, &arena);
+    static_assert(std::is_same_v<decltype(b), std::pmr::vector<int>>);
+    CHECK(same_elements(b, fff::filter(v, by3)));
+
+    CHECK(same_elements(fff::reject(v, by3, &arena), fff::reject(v, by3)));
+
+    // with a parallel policy as well, and to another value type
+    auto d = fff::map(execution::par, v, [](int x) {return x * 0.5;}, &arena);
+    static_assert(std::is_same_v<decltype(d), std::pmr::vector<double>>);
+    CHECK(d[3] == v[3] * 0.5);
+    CHECK(same_elements(fff::filter(execution::par, v, by3, &arena), b));
+    CHECK(same_elements(fff::reject(execution::par, v, by3, &arena), fff::reject(v, by3)));
+    CHECK(same_elements(fff::filter(execution::par_unseq, v, fff::static_r_bind<500>(std::less<>()), &arena),
+                        fff::filter(v, fff::static_r_bind<500>(std::less<>()))));
+
+    // the same kind of container, with the allocator swapped in
+    const std::list<int> l(v.begin(), v.end());
+    auto f = fff::filter(execution::par, l, by3, std::pmr::polymorphic_allocator<int>(&arena));
+    static_assert(std::is_same_v<decltype(f), std::pmr::list<int>>);
+    CHECK(same_elements(f, b));
+
+    const std::set<int> s(v.begin(), v.end());
+    auto g = fff::filter(s, by3, &arena);
+    static_assert(std::is_same_v<decltype(g), std::pmr::set<int>>);
+    CHECK(g.size() == 334);
+
+    const std::unordered_set<int> us(v.begin(), v.end());
+    auto h = fff::filter(us, by3, &arena);
+    static_assert(std::is_same_v<decltype(h), std::pmr::unordered_set<int>>);
+    CHECK(h.size() == 334);
+
+    const std::string str = "hello world";
+    auto st = fff::filter(str, [](char ch) {return ch != 'o';}, &arena);
+    static_assert(std::is_same_v<decltype(st), std::pmr::string>);
+    CHECK(st == "hell wrld");
+
+    const std::deque<int> dq(v.begin(), v.end());
+    CHECK(fff::filter(execution::par, dq, by3, &arena).size() == b.size());
+
+    // any allocator, rebound to the result's value type
+    auto cv = fff::map(v, plus7, counting<char>());
+    static_assert(std::is_same_v<decltype(cv), std::vector<int, counting<int>>>);
+    CHECK(counting<int>::allocations == 1);
+
+    return fff_test::result();
+}
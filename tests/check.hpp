@@ -0,0 +1,61 @@
+#ifndef UNDERSCORE_CPP_TESTS_CHECK_HPP
+#define UNDERSCORE_CPP_TESTS_CHECK_HPP
+
+#include <iostream>
+
+/*
+* A minimal checker for the tests : a failed CHECK prints where it failed and the test goes on;
+* main() returns fff_test::result(), which is non-zero if any CHECK failed.
+* It does not depend on assert(), so it checks in a release build too.
+*/
+namespace fff_test {
+
+    inline int failures = 0;
+
+    inline void check(bool ok, const char *what, const char *file, int line) {
+        if (not ok) {
+            ++failures;
+            std::cerr << file << ':' << line << ": CHECK(" << what << ") failed\n";
+        }
+    }
+
+    template<class E, class F>
+    void check_throws(F &&f, const char *what, const char *file, int line) {
+        bool thrown = false;
+        try {
+            f();
+        } catch (const E &) {
+            thrown = true;
+        }
+        check(thrown, what, file, line);
+    }
+
+    /**
+    * false if this test was built for an instruction set (-mavx2) that the machine does not have;
+    * such a test returns skipped() instead of running.
+    */
+    inline bool target_supported() {
+#if defined(__AVX2__)
+        return __builtin_cpu_supports("avx2");
+#else
+        return true;
+#endif
+    }
+
+    /**
+    * The exit code that CTest counts as a skipped test (SKIP_RETURN_CODE).
+    */
+    constexpr inline int skipped = 77;
+
+    inline int result() {
+        if (failures != 0) {
+            std::cerr << failures << " check(s) failed\n";
+        }
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+#define CHECK(...) ::fff_test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+#define CHECK_THROWS(E, ...) ::fff_test::check_throws<E>([&] { (void) (__VA_ARGS__); }, #__VA_ARGS__ " throws " #E, __FILE__, __LINE__)
+
+#endif//UNDERSCORE_CPP_TESTS_CHECK_HPP
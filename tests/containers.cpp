@@ -0,0 +1,80 @@
+#include <functional>
+#include <list>
+#include <numeric>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace {
+    // orders by the key only, so elements with the same key are equivalent but can be told apart
+    struct ByKey {
+        bool operator()(const std::pair<int, int> &a, const std::pair<int, int> &b) const {
+            return a.first < b.first;
+        }
+    };
+}
+
+int main() {
+    const std::vector<int> v{5, 3, 9, 3, 1, 7, 5};
+    const auto odd = [](int x) {return x % 2 == 1;};
+    const auto neg = [](int x) {return -x;};
+
+    // an ordered result gets the values in any order, sorted and made unique once
+    CHECK(fff::map(std::set<int>{1, 2, 3}, neg) == std::set<int>{-3, -2, -1});
+    CHECK(fff::filter(std::multiset<int>(v.begin(), v.end()), odd) == std::multiset<int>(v.begin(), v.end()));
+    CHECK(fff::map(std::multiset<int>{1, 1, 2}, neg) == std::multiset<int>{-2, -1, -1});
+
+    // the comparator of the input is kept
+    const std::set<int, std::greater<>> desc{1, 2, 3, 4};
+    const auto kept = fff::filter(desc, [](int x) {return x > 1;});
+    CHECK(std::vector<int>(kept.begin(), kept.end()) == std::vector<int>{4, 3, 2});
+    CHECK(fff::map(desc, neg) == std::set<int, std::greater<>>{-1, -2, -3, -4});
+
+    // appending to an ordered container that already has elements
+    std::set<int> s{4, 100};
+    fff::map_into(s, v, [](int x) {return x - 1;});
+    CHECK(s == std::set<int>{0, 2, 4, 6, 8, 100});
+    fff::filter_into(s, std::set<int>{1, 3, 200}, odd);
+    CHECK(s == std::set<int>{0, 1, 2, 3, 4, 6, 8, 100});
+
+    // equivalent elements keep their order, and a unique result keeps the first of them
+    std::multiset<std::pair<int, int>, ByKey> tagged;
+    for (int i = 0; i < 600; ++i) {
+        tagged.emplace(i % 3, i);
+    }
+    const auto flipped = fff::map(tagged, [](const std::pair<int, int> &p) {return std::pair(-p.first, p.second);});
+    std::vector<std::pair<int, int>> want;
+    for (int k = -2; k <= 0; ++k) {
+        for (int i = -k; i < 600; i += 3) {
+            want.emplace_back(k, i);
+        }
+    }
+    CHECK(std::vector<std::pair<int, int>>(flipped.begin(), flipped.end()) == want);
+
+    std::set<std::pair<int, int>, ByKey> firsts;
+    std::vector<int> order(600);
+    std::iota(order.begin(), order.end(), 0);
+    fff::map_into(firsts, order, [](int i) {return std::pair(i % 3, i);});
+    CHECK(std::vector<std::pair<int, int>>(firsts.begin(), firsts.end()) == (std::vector<std::pair<int, int>>{{0, 0}, {1, 1}, {2, 2}}));
+
+    // unordered results
+    const std::unordered_set<int> us(v.begin(), v.end());
+    CHECK(fff::map(us, neg) == std::unordered_set<int>{-1, -3, -5, -7, -9});
+    CHECK(fff::filter(us, [](int x) {return x > 4;}) == std::unordered_set<int>{5, 7, 9});
+
+    // sequences
+    CHECK(fff::map(std::list<int>{1, 2}, neg) == std::list<int>{-1, -2});
+    CHECK(fff::filter(std::string("a-b-c"), [](char c) {return c != '-';}) == "abc");
+    CHECK(fff::map(std::string("abc"), [](char c) {return static_cast<char>(c - 32);}) == "ABC");
+
+    const auto sized = fff::map(v, neg);
+    CHECK(sized.size() == v.size() and sized.front() == -5 and sized.back() == -5);
+
+    return fff_test::result();
+}
@@ -0,0 +1,64 @@
+#include <thread>
+#include <vector>
+
+#include "ffffff/practice.hpp"
+#include "ffffff/utils.hpp"
+
+#include "check.hpp"
+
+template<class F>
+void on_threads(int n, F f) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n; ++t) {
+        threads.emplace_back(f);
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+int main() {
+    // no add is lost, whatever the number of cells
+    for (std::size_t shards : {1u, 3u, 8u, 64u}) {
+        fff::ShardedCounter c(shards);
+        on_threads(8, [&c] {
+            for (int i = 0; i < 10'000; ++i) {
+                c.inc();
+            }
+            c.add(-5);
+        });
+        CHECK(c.get() == 8 * 10'000 - 8 * 5);
+
+        // a copy starts from the total; a reset starts from zero
+        fff::ShardedCounter copy = c;
+        CHECK(copy.get() == c.get());
+        c.reset();
+        CHECK(c.get() == 0);
+        c = copy;
+        CHECK(c.get() == copy.get());
+    }
+
+    // fff::count counts the calls from every thread, and still returns what f returns
+    {
+        auto g = fff::count([](int x) {return x + 1;});
+        CHECK(g(1) == 2);
+        on_threads(4, [&g] {
+            for (int i = 0; i < 1000; ++i) {
+                g(i);
+            }
+        });
+        CHECK(g.get_count() == 1 + 4 * 1000);
+    }
+
+    {
+        fff::ThreadsafeCounter c;
+        on_threads(4, [&c] {
+            for (int i = 0; i < 1000; ++i) {
+                c.inc();
+            }
+        });
+        CHECK(c.get() == 4000);
+    }
+
+    return fff_test::result();
+}
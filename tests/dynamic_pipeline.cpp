@@ -0,0 +1,84 @@
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "ffffff/dynamic_pipeline.hpp"
+
+#include "check.hpp"
+
+int main() {
+    int fused_calls = 0;
+
+    fff::stage_registry reg;
+    reg.add<std::string>("parse", [](const std::string &s) {return std::stoi(s);});
+    reg.filter<int>("nonzero", [](int n) {return n != 0;});
+    reg.map<int>("scale", [](int n) {return n * 10;});
+    reg.map<int>("half", [](int n) -> std::optional<int> {
+        if (n % 2) {
+            return std::nullopt;
+        }
+        return n / 2;
+    });
+    reg.map<int>("show", [](int n) {return std::to_string(n);});
+
+    // a spec round-trips its values, and a filter or an empty optional drops them
+    {
+        fff::dynamic_pipeline<std::string, int> p(reg, "parse | filter:nonzero | map:scale");
+        CHECK(p.size() == 3);
+        CHECK(p("3") == 30);
+        CHECK(p("-4") == -40);
+        CHECK(p("0") == std::nullopt);
+
+        fff::dynamic_pipeline<int, std::string> q(reg, "map:half|map:show");
+        CHECK(q(8) == std::optional<std::string>("4"));
+        CHECK(q(7) == std::nullopt);
+    }
+
+    // a fused run of stages replaces them, with the same results
+    {
+        reg.fuse<int>("filter:nonzero|map:scale", [&fused_calls](int n) {
+            ++fused_calls;
+            return n ? std::optional(n * 10) : std::nullopt;
+        });
+
+        fff::dynamic_pipeline<std::string, int> p(reg, "parse|filter:nonzero|map:scale");
+        CHECK(p.size() == 2);
+        CHECK(p("3") == 30);
+        CHECK(p("0") == std::nullopt);
+        CHECK(fused_calls == 2);
+
+        // the stages on their own are not fused
+        fff::dynamic_pipeline<int, int> alone(reg, "map:scale");
+        CHECK(alone(2) == 20);
+        CHECK(fused_calls == 2);
+    }
+
+    // a pipeline keeps its own stages
+    {
+        fff::dynamic_pipeline<int, int> p(reg, "map:scale");
+        reg.map<int>("scale", [](int n) {return n * 100;});
+        CHECK(p(1) == 10);
+        CHECK(fff::dynamic_pipeline<int, int>(reg, "map:scale")(1) == 100);
+
+        // and the fused segment made from the old "map:scale" is gone
+        fff::dynamic_pipeline<std::string, int> q(reg, "parse|filter:nonzero|map:scale");
+        CHECK(q.size() == 3);
+        CHECK(q("3") == 300);
+        CHECK(q("0") == std::nullopt);
+        CHECK(fused_calls == 2);
+    }
+
+    // bad specs and bad names
+    {
+        using P = fff::dynamic_pipeline<std::string, int>;
+        CHECK_THROWS(std::invalid_argument, P(reg, ""));
+        CHECK_THROWS(std::invalid_argument, P(reg, "parse||map:scale"));
+        CHECK_THROWS(std::invalid_argument, P(reg, "parse|map:nope"));
+        CHECK_THROWS(std::invalid_argument, P(reg, "map:scale"));          // takes int, not std::string
+        CHECK_THROWS(std::invalid_argument, P(reg, "parse|map:show"));     // makes std::string, not int
+        CHECK_THROWS(std::invalid_argument, reg.add<int>("a|b", [](int n) {return n;}));
+        CHECK_THROWS(std::invalid_argument, reg.fuse<std::string>("parse|map:show", [](const std::string &s) {return s.size();})); // makes std::size_t, not std::string
+    }
+
+    return fff_test::result();
+}
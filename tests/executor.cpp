@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+
+#include "ffffff/executor.hpp"
+
+#include "check.hpp"
+
+int main() {
+    // FFFFFF_THREADS, set by CTest, overrides the hardware concurrency
+    if (const char *env = std::getenv("FFFFFF_THREADS")) {
+        CHECK(fff::liated::default_concurrency() == std::strtoul(env, nullptr, 10));
+    }
+
+    // every spawned task runs exactly once before wait() returns
+    {
+        std::atomic<int> sum = 0;
+        fff::task_group g;
+        for (int i = 1; i <= 1000; ++i) {
+            g.spawn([&sum, i] { sum += i; });
+        }
+        g.wait();
+        CHECK(sum == 500500);
+    }
+
+    // nested groups do not dead-lock, since a waiting thread runs queued tasks
+    {
+        std::atomic<int> leaves = 0;
+        fff::task_group outer;
+        for (int i = 0; i < 16; ++i) {
+            outer.spawn([&leaves] {
+                fff::task_group inner;
+                for (int j = 0; j < 16; ++j) {
+                    inner.spawn([&leaves] { ++leaves; });
+                }
+                inner.wait();
+            });
+        }
+        outer.wait();
+        CHECK(leaves == 256);
+    }
+
+    // the first exception of a task is rethrown by wait(), after every task has finished
+    {
+        std::atomic<int> done = 0;
+        fff::task_group g;
+        g.spawn([] { throw std::runtime_error("boom"); });
+        for (int i = 0; i < 8; ++i) {
+            g.spawn([&done] { ++done; });
+        }
+        CHECK_THROWS(std::runtime_error, g.wait());
+        CHECK(done == 8);
+    }
+
+    // a private executor takes move-only tasks, and runs what is still queued before it is destroyed
+    {
+        std::atomic<int> ran = 0;
+        {
+            fff::executor ex(3);
+            CHECK(ex.size() == 3);
+            for (int i = 0; i < 100; ++i) {
+                ex.submit([&ran, p = std::make_unique<int>(1)] { ran += *p; });
+            }
+        }
+        CHECK(ran == 100);
+    }
+
+    return fff_test::result();
+}
@@ -0,0 +1,61 @@
+#include <atomic>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+namespace {
+    constexpr fff::Filter filter;
+    constexpr fff::Reject reject;
+}
+
+int main() {
+    std::vector<std::string> words(60'000);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] = std::to_string(i * 7919 % 60'000);
+    }
+    const auto short_word = [](const std::string &s) {return s.size() < 4;};
+
+    // the count-then-scatter path keeps the input order
+    CHECK(filter(execution::par, words, short_word) == filter(words, short_word));
+    CHECK(reject(execution::par, words, short_word) == reject(words, short_word));
+
+    // and calls the predicate once per element
+    std::atomic<std::size_t> calls = 0;
+    const auto counted = filter(execution::par, words, [&calls](const std::string &s) {
+        ++calls;
+        return s.front() == '1';
+    });
+    CHECK(calls == words.size());
+    CHECK(counted == filter(words, [](const std::string &s) {return s.front() == '1';}));
+
+    // a deque is split as well
+    const std::deque<std::string> dq(words.begin(), words.end());
+    CHECK(filter(execution::par, dq, short_word) == filter(dq, short_word));
+
+    // std::vector<bool> has no lvalue elements, so every block filters into its own part, joined in order
+    std::vector<bool> bits(50'000);
+    for (std::size_t i = 0; i < bits.size(); ++i) {
+        bits[i] = i % 3 == 0;
+    }
+    const auto set = [](bool b) {return b;};
+    CHECK(filter(execution::par, bits, set) == filter(bits, set));
+    CHECK(filter(execution::par, bits, set).size() == 16'667);
+
+    // the in-place parallel filter of an rvalue closes the gaps between the blocks in order
+    auto moved = filter(execution::par, std::vector<std::string>(words), short_word);
+    CHECK(moved == filter(words, short_word));
+
+    // a block with no survivor at all
+    std::vector<int> v(40'000, 0);
+    v[39'999] = 1;
+    CHECK(filter(execution::par, v, [](int x) {return x == 1;}) == std::vector<int>{1});
+    CHECK(filter(execution::par, std::vector<int>(v), [](int x) {return x == 1;}) == std::vector<int>{1});
+
+    return fff_test::result();
+}
@@ -0,0 +1,66 @@
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "ffffff/bind.hpp"
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* find_index, some, every and none give what the sequential loop gives, under every policy,
+* wherever the first match is (or if there is none).
+*/
+template<class Policy>
+void same_as_seq(Policy policy) {
+    const std::size_t n = 100'000;
+
+    for (std::size_t at : {std::size_t(0), std::size_t(1), std::size_t(63), std::size_t(64), std::size_t(4095),
+                           std::size_t(12'500), std::size_t(50'001), n - 1, n}) {
+        std::vector<int> v(n, 1);
+        if (at < n) {
+            v[at] = -1;
+            // later matches, in later blocks, must not win
+            for (std::size_t later = at + 1; later < n; later += 9'973) {
+                v[later] = -2;
+            }
+        }
+
+        const auto neg = [](int x) {return x < 0;};
+        const auto neg_k = fff::static_r_bind<0>(std::less<>());
+        const long want = at < n ? static_cast<long>(at) : -1;
+
+        CHECK(fff::find_index(v, neg) == want);
+        CHECK(fff::find_index(policy, v, neg) == want);
+        CHECK(fff::find_index(policy, v, neg_k) == want);
+
+        CHECK(fff::some(policy, v, neg_k) == (at < n));
+        CHECK(fff::none(policy, v, neg) == (at == n));
+        CHECK(fff::every(policy, v, fff::static_r_bind<0>(std::greater<>())) == (at == n));
+    }
+
+    const std::list<int> l{3, 4, -5, 6};
+    CHECK(fff::find_index(policy, l, [](int x) {return x < 0;}) == 2);
+
+    const std::vector<float> f{1.f, 2.f, 0.5f, -0.f};
+    CHECK(fff::find_index(policy, f, fff::static_r_bind<1>(std::less<>())) == 2);
+    CHECK(fff::find_index(policy, f, fff::static_r_bind<0>(std::equal_to<>())) == 3);
+
+    const std::vector<int> e;
+    CHECK(fff::find_index(policy, e, [](int) {return true;}) == -1);
+}
+
+int main() {
+    if (not fff_test::target_supported()) {
+        return fff_test::skipped;
+    }
+
+    same_as_seq(execution::seq);
+    same_as_seq(execution::unseq);
+    same_as_seq(execution::par);
+    same_as_seq(execution::par_unseq);
+
+    return fff_test::result();
+}
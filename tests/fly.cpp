@@ -0,0 +1,76 @@
+#include <array>
+
+#include "ffffff/utils.hpp"
+
+#include "check.hpp"
+
+/**
+* returns where it lives, to tell a shared f from a copied one
+*/
+struct where {
+    std::array<char, 64> big{};
+
+    const where *operator()() const {
+        return this;
+    }
+};
+
+int main() {
+    // the Fly stays small, whatever F is
+    {
+        auto f = fff::fly(where{});
+        CHECK(sizeof(f) == sizeof(void *));
+        CHECK(f() != nullptr);
+    }
+
+    // heap : a copy has its own f
+    {
+        auto a = fff::fly(where{});
+        auto b = a;
+        CHECK(a() != b());
+
+        // and a const Fly still calls a non-const f
+        const auto counter = fff::fly([n = 0]() mutable {return ++n;});
+        CHECK(counter() == 1);
+        CHECK(counter() == 2);
+    }
+
+    // small : a small f lives inside the Fly, a large one on the heap
+    {
+        auto add = fff::fly(fff::fly_storage::small<>(), [](int x, int y) {return x + y;});
+        CHECK(add(2, 3) == 5);
+        auto copy = add;
+        CHECK(copy(4, 5) == 9);
+
+        auto big = fff::fly(fff::fly_storage::small<>(), where{});
+        CHECK(sizeof(big) == sizeof(void *));
+        auto big_copy = big;
+        CHECK(big() != big_copy());
+
+        int n = 0;
+        auto counter = fff::fly(fff::fly_storage::small<>(), [n]() mutable {return ++n;});
+        CHECK(counter() == 1);
+        CHECK(counter() == 2);
+        auto counter_copy = counter;
+        CHECK(counter_copy() == 3);
+        CHECK(counter() == 3);
+    }
+
+    // shared : copies share one f, until a non-const call copies it on write
+    {
+        auto a = fff::fly(fff::fly_storage::shared(), where{});
+        auto b = a;
+        CHECK(a() == b());
+
+        int n = 0;
+        auto counter = fff::fly(fff::fly_storage::shared(), [n]() mutable {return ++n;});
+        CHECK(counter() == 1);
+        auto copy = counter;
+        CHECK(copy() == 2);     // copy gets its own f here
+        CHECK(copy() == 3);
+        CHECK(counter() == 2);  // the original is left as it was
+        CHECK(counter() == 3);
+    }
+
+    return fff_test::result();
+}
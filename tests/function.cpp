@@ -0,0 +1,110 @@
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ffffff/function.hpp"
+
+#include "check.hpp"
+
+int twice(int x) {
+    return 2 * x;
+}
+
+/**
+* counts its live copies, to see that every copy made is destroyed
+*/
+struct tracked {
+    inline static int alive = 0;
+    std::array<long, 16> big{}; // too big to be kept inline
+
+    tracked() {++alive;}
+    tracked(const tracked &) {++alive;}
+    tracked(tracked &&) noexcept {++alive;}
+    ~tracked() {--alive;}
+
+    int operator()(int x) const {
+        return x + static_cast<int>(big.size());
+    }
+};
+
+int main() {
+    // a small callable is kept inline, a big one on the heap; both round-trip through copies and moves
+    {
+        int k = 3;
+        auto small = [k](int x) {return x * k;};
+        static_assert(fff::function<int(int)>::stored_inline<decltype(small)>);
+        static_assert(not fff::function<int(int)>::stored_inline<tracked>);
+
+        fff::function<int(int)> f = small;
+        CHECK(f(5) == 15);
+
+        fff::function<int(int)> g = tracked();
+        CHECK(g(1) == 17);
+
+        auto f2 = f;
+        auto g2 = g;
+        CHECK(f2(2) == 6);
+        CHECK(g2(2) == 18);
+
+        auto f3 = std::move(f);
+        auto g3 = std::move(g);
+        CHECK(not f);
+        CHECK(not g);
+        CHECK(f3(1) == 3);
+        CHECK(g3(1) == 17);
+
+        f3.swap(g3);
+        CHECK(f3(1) == 17);
+        CHECK(g3(1) == 3);
+
+        f3 = g3;
+        CHECK(f3(1) == 3);
+    }
+    CHECK(tracked::alive == 0);
+
+    // function pointers, and a null one making an empty handle
+    {
+        fff::function<int(int)> f = &twice;
+        CHECK(f(21) == 42);
+
+        int (*null)(int) = nullptr;
+        fff::function<int(int)> e = null;
+        CHECK(e == nullptr);
+        CHECK_THROWS(std::bad_function_call, e(1));
+
+        fff::function<int(int)> d;
+        CHECK_THROWS(std::bad_function_call, d(1));
+
+        f = nullptr;
+        CHECK(not f);
+    }
+
+    // a move-only handle takes move-only callables, inline or not
+    {
+        fff::move_only_function<int()> f = [p = std::make_unique<int>(7)] {return *p;};
+        CHECK(f() == 7);
+        auto g = std::move(f);
+        CHECK(not f);
+        CHECK(g() == 7);
+
+        fff::move_only_function<std::string()> h = [p = std::make_unique<std::string>("heap"), pad = std::array<long, 16>{}] {
+            return *p + std::to_string(pad.size());
+        };
+        auto h2 = std::move(h);
+        CHECK(h2() == "heap16");
+    }
+
+    // arguments keep their value category, and void results are fine
+    {
+        std::vector<std::string> out;
+        fff::function<void(std::string &&)> sink = [&out](std::string &&s) {out.push_back(std::move(s));};
+        std::string s = "moved";
+        sink(std::move(s));
+        CHECK(out.size() == 1 and out[0] == "moved");
+    }
+
+    return fff_test::result();
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+int main() {
+    const auto twice = [](int x) {return x * 2;};
+    const auto odd = [](int x) {return x % 2 == 1;};
+
+    // an rvalue mapped to its own value type is mapped in its own storage
+    {
+        std::vector<int> v{1, 2, 3, 4, 5};
+        const int *p = v.data();
+        auto got = fff::map(std::move(v), twice);
+        CHECK(got == std::vector<int>{2, 4, 6, 8, 10});
+        CHECK(got.data() == p);
+    }
+    {
+        std::vector<int> v(50'000, 3);
+        const int *p = v.data();
+        auto got = fff::map(execution::par, std::move(v), twice);
+        CHECK(got == std::vector<int>(50'000, 6));
+        CHECK(got.data() == p);
+    }
+    {
+        std::vector<std::string> v{"a", "b"};
+        const std::string *p = v.data();
+        auto got = fff::map(std::move(v), [](const std::string &s) {return s + s;});
+        CHECK(got == std::vector<std::string>{"aa", "bb"});
+        CHECK(got.data() == p);
+    }
+
+    // to another value type, a new container is made
+    {
+        auto got = fff::map(std::vector<int>{1, 2}, [](int x) {return x * 0.5;});
+        CHECK(got == std::vector<double>{0.5, 1.0});
+    }
+
+    // an lvalue is never touched
+    {
+        const std::vector<int> v{1, 2, 3};
+        CHECK(fff::map(v, twice) == std::vector<int>{2, 4, 6});
+        CHECK(v == std::vector<int>{1, 2, 3});
+    }
+
+    // an rvalue is filtered by erasing from it
+    {
+        std::vector<int> v{1, 2, 3, 4, 5};
+        const int *p = v.data();
+        auto kept = fff::filter(std::move(v), odd);
+        CHECK(kept == std::vector<int>{1, 3, 5});
+        CHECK(kept.data() == p);
+    }
+    {
+        std::vector<int> v{1, 2, 3, 4, 5};
+        const int *p = v.data();
+        auto kept = fff::reject(std::move(v), odd);
+        CHECK(kept == std::vector<int>{2, 4});
+        CHECK(kept.data() == p);
+    }
+    {
+        std::vector<std::string> v(30'000);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            v[i] = std::to_string(i);
+        }
+        const std::string *p = v.data();
+        auto kept = fff::filter(execution::par, std::move(v), [](const std::string &s) {return s.back() == '7';});
+        CHECK(kept.size() == 3'000);
+        CHECK(kept.front() == "7" and kept.back() == "29997");
+        CHECK(kept.data() == p);
+    }
+    // when every element is kept, no run is moved onto itself
+    {
+        std::vector<std::string> v(30'000);
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            v[i] = std::to_string(i);
+        }
+        const auto want = v;
+        auto kept = fff::filter(execution::par, std::move(v), [](const std::string &) {return true;});
+        CHECK(kept == want);
+    }
+    {
+        auto kept = fff::filter(execution::par, std::vector<std::vector<int>>(20'000, {1, 2, 3}),
+                                [](const std::vector<int> &) {return true;});
+        CHECK(kept.size() == 20'000);
+        CHECK(std::ranges::none_of(kept, [](const std::vector<int> &x) {return x != std::vector<int>{1, 2, 3};}));
+    }
+    {
+        std::list<int> l{1, 2, 3, 4};
+        const int *first = &l.front();
+        auto kept = fff::filter(std::move(l), odd);
+        CHECK(kept == std::list<int>{1, 3});
+        CHECK(&kept.front() == first);
+    }
+
+    return fff_test::result();
+}
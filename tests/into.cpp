@@ -0,0 +1,79 @@
+#include <deque>
+#include <iterator>
+#include <set>
+#include <span>
+#include <vector>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+int main() {
+    const std::vector<int> v{1, 2, 3, 4, 5, 6};
+    const auto twice = [](int x) {return x * 2;};
+    const auto odd = [](int x) {return x % 2 == 1;};
+
+    // a span is filled from the front, up to its size, and the written part is returned
+    {
+        std::vector<int> scratch(8, 0);
+        auto got = fff::map_into(std::span(scratch), v, twice);
+        CHECK(got.data() == scratch.data());
+        CHECK(std::vector<int>(got.begin(), got.end()) == std::vector<int>{2, 4, 6, 8, 10, 12});
+        CHECK(scratch[6] == 0 and scratch[7] == 0);
+
+        std::vector<int> small(4, 0);
+        CHECK(fff::map_into(std::span(small), v, twice).size() == 4);
+        CHECK(small == std::vector<int>{2, 4, 6, 8});
+
+        auto kept = fff::filter_into(std::span(scratch), v, odd);
+        CHECK(std::vector<int>(kept.begin(), kept.end()) == std::vector<int>{1, 3, 5});
+
+        // a span that gets full drops the remaining survivors
+        std::vector<int> two(2, 0);
+        CHECK(fff::reject_into(std::span(two), v, odd).size() == 2);
+        CHECK(two == std::vector<int>{2, 4});
+    }
+
+    // an output iterator is written from on, and the end is returned
+    {
+        int buf[6] = {};
+        CHECK(fff::map_into(buf + 0, v, twice) == buf + 6);
+        CHECK(buf[5] == 12);
+
+        std::vector<int> out;
+        fff::filter_into(std::back_inserter(out), v, odd);
+        CHECK(out == std::vector<int>{1, 3, 5});
+    }
+
+    // a container is appended to
+    {
+        std::vector<int> out{0};
+        fff::map_into(out, v, twice);
+        CHECK(out == std::vector<int>{0, 2, 4, 6, 8, 10, 12});
+
+        std::deque<int> dq{-1};
+        fff::reject_into(dq, v, odd);
+        CHECK(dq == std::deque<int>{-1, 2, 4, 6});
+
+        std::set<int> s{100};
+        fff::map_into(s, v, [](int x) {return x % 3;});
+        CHECK(s == std::set<int>{0, 1, 2, 100});
+
+        std::set<int> f;
+        fff::filter_into(f, std::vector<int>{5, 3, 1, 3}, odd);
+        CHECK(f == std::set<int>{1, 3, 5});
+    }
+
+    // the same scratch serves request after request without an allocation
+    {
+        std::vector<int> scratch(1024);
+        const int *p = scratch.data();
+        for (int round = 0; round < 3; ++round) {
+            auto got = fff::filter_into(std::span(scratch), v, [round](int x) {return x > round;});
+            CHECK(got.size() == static_cast<std::size_t>(6 - round));
+        }
+        CHECK(scratch.data() == p);
+    }
+
+    return fff_test::result();
+}
@@ -0,0 +1,60 @@
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+int main() {
+    const std::map<std::string, int> m{{"a", 1}, {"b", 2}, {"c", 3}};
+
+    // V -> U, or (V, K) -> U, as _.mapObject() does
+    CHECK(fff::map_values(m, [](int v) {return v * 10;}) == std::map<std::string, int>{{"a", 10}, {"b", 20}, {"c", 30}});
+    CHECK(fff::map_values(m, [](int v, const std::string &k) {return k + std::to_string(v);})
+          == std::map<std::string, std::string>{{"a", "a1"}, {"b", "b2"}, {"c", "c3"}});
+
+    // an rvalue map whose values keep their type keeps its nodes
+    {
+        auto r = m;
+        const int *node = &r.at("b");
+        auto got = fff::map_values(std::move(r), [](int v) {return v + 1;});
+        CHECK(got == std::map<std::string, int>{{"a", 2}, {"b", 3}, {"c", 4}});
+        CHECK(&got.at("b") == node);
+    }
+
+    // an rvalue map whose values change their type gives its keys and values up, moved
+    {
+        std::map<std::string, std::unique_ptr<int>> r;
+        r.emplace("x", std::make_unique<int>(4));
+        r.emplace("y", std::make_unique<int>(5));
+        auto got = fff::map_values(std::move(r), [](std::unique_ptr<int> &&p) {return std::move(p);});
+        static_assert(std::is_same_v<decltype(got), std::map<std::string, std::unique_ptr<int>>>);
+        CHECK(*got.at("x") == 4 and *got.at("y") == 5);
+
+        std::map<std::string, std::string> words{{"one", "1"}, {"two", "22"}};
+        auto sizes = fff::map_values(std::move(words), [](std::string &&s) {return s.size();});
+        CHECK(sizes == std::map<std::string, std::size_t>{{"one", 1}, {"two", 2}});
+        CHECK(words.empty());
+    }
+
+    // the comparator of the input is kept
+    {
+        const std::map<int, int, std::greater<>> desc{{1, 1}, {2, 2}};
+        auto got = fff::map_values(desc, [](int v) {return v * 0.5;});
+        static_assert(std::is_same_v<decltype(got), std::map<int, double, std::greater<>>>);
+        CHECK(got.begin()->first == 2);
+    }
+
+    // unordered maps
+    {
+        const std::unordered_map<int, int> um{{1, 10}, {2, 20}};
+        CHECK(fff::map_values(um, [](int v, int k) {return v + k;}) == std::unordered_map<int, int>{{1, 11}, {2, 22}});
+        CHECK(fff::map_values(std::unordered_map<int, int>(um), [](int v) {return std::to_string(v);})
+              == std::unordered_map<int, std::string>{{1, "10"}, {2, "20"}});
+    }
+
+    return fff_test::result();
+}
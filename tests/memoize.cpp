@@ -0,0 +1,102 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ffffff/memoize.hpp"
+
+#include "check.hpp"
+
+int calls = 0;
+
+long square(int x) {
+    ++calls;
+    return static_cast<long>(x) * x;
+}
+
+int main() {
+    // a miss calls f, a hit returns what it returned
+    {
+        calls = 0;
+        auto m = fff::memoize(square);
+        CHECK(m(12) == 144);
+        CHECK(m(12) == 144);
+        CHECK(m(-3) == 9);
+        CHECK(calls == 2);
+
+        const auto st = m.stats();
+        CHECK(st.hits == 1);
+        CHECK(st.misses == 2);
+        CHECK(st.size == 2);
+
+        // copies share the cache
+        auto copy = m;
+        CHECK(copy(-3) == 9);
+        CHECK(calls == 2);
+
+        m.clear();
+        CHECK(m(12) == 144);
+        CHECK(calls == 3);
+    }
+
+    // the key is every parameter, decayed
+    {
+        std::atomic<int> runs = 0;
+        auto m = fff::memoize([&runs](const std::string &s, int n) {
+            ++runs;
+            return s.size() * static_cast<std::size_t>(n);
+        });
+        CHECK(m(std::string("abc"), 2) == 6);
+        CHECK(m(std::string("abc"), 3) == 9);
+        CHECK(m(std::string("abc"), 2) == 6);
+        CHECK(runs == 2);
+    }
+
+    // with a capacity, the least recently used goes first
+    {
+        calls = 0;
+        auto m = fff::memoize(square, 16); // one shard of 16
+        for (int i = 0; i < 16; ++i) {
+            m(i);
+        }
+        m(0);           // 0 is now the most recent, 1 the least
+        m(100);         // evicts 1
+        CHECK(m.stats().evictions == 1);
+        CHECK(m.stats().size == 16);
+
+        calls = 0;
+        m(0);
+        CHECK(calls == 0);
+        m(1);
+        CHECK(calls == 1);
+    }
+
+    // many threads over many keys, spread over the shards : every result is right, and each key misses at most once per racing thread
+    {
+        std::atomic<int> runs = 0;
+        auto m = fff::memoize([&runs](int x) {++runs; return x * 3;});
+
+        std::atomic<int> wrong = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                for (int r = 0; r < 3; ++r) {
+                    for (int x = 0; x < 5000; ++x) {
+                        if (m(x) != x * 3) {
+                            ++wrong;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        CHECK(wrong == 0);
+        CHECK(m.stats().size == 5000);
+        CHECK(runs >= 5000 and runs <= 4 * 5000);
+        CHECK(m.stats().hits + m.stats().misses == 4 * 3 * 5000);
+    }
+
+    return fff_test::result();
+}
@@ -0,0 +1,75 @@
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ffffff/utils.hpp"
+
+#include "check.hpp"
+
+int main() {
+    // f runs on the first call only, and every call returns the same object
+    {
+        int runs = 0;
+        auto o = fff::once([&runs] {++runs; return std::string("value");});
+        CHECK(runs == 0);
+        const std::string &a = o();
+        const std::string &b = o();
+        CHECK(a == "value");
+        CHECK(&a == &b);
+        CHECK(runs == 1);
+    }
+
+    // concurrent first calls run f once, and all of them see its result
+    for (int round = 0; round < 20; ++round) {
+        std::atomic<int> runs = 0;
+        auto o = fff::once([&runs] {
+            ++runs;
+            std::this_thread::yield();
+            return std::vector<int>(100, 7);
+        });
+
+        std::atomic<int> good = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&] {
+                if (o().size() == 100 and o()[99] == 7) {
+                    ++good;
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+        CHECK(runs == 1);
+        CHECK(good == 8);
+    }
+
+    // an exception goes to its caller, and the next call tries again
+    {
+        int runs = 0;
+        auto o = fff::once([&runs] {
+            if (++runs == 1) {
+                throw std::runtime_error("first");
+            }
+            return runs;
+        });
+        CHECK_THROWS(std::runtime_error, o());
+        CHECK(o() == 2);
+        CHECK(o() == 2);
+        CHECK(runs == 2);
+    }
+
+    // a copy takes the result along, and does not run f again
+    {
+        int runs = 0;
+        auto o = fff::once([&runs] {return ++runs;});
+        CHECK(o() == 1);
+        auto copy = o;
+        CHECK(copy() == 1);
+        CHECK(runs == 1);
+    }
+
+    return fff_test::result();
+}
@@ -0,0 +1,89 @@
+#include <atomic>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+namespace {
+    constexpr fff::Map map;
+    constexpr fff::Filter filter;
+    constexpr fff::Reject reject;
+    constexpr fff::Each each;
+}
+
+/*
+* Every parallel policy gives what the sequential call gives, over a vector large enough to be split.
+*/
+template<class Policy>
+void same_as_seq(Policy policy) {
+    std::vector<int> v(100'000);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>(i * 7919 % 1000) - 500;
+    }
+
+    const auto sq = [](int x) {return x * x;};
+    const auto str = [](int x) {return std::to_string(x);};
+    const auto pos = [](int x) {return x > 0;};
+
+    CHECK(map(policy, v, sq) == map(v, sq));
+    CHECK(map(policy, v, str) == map(v, str));
+    CHECK(filter(policy, v, pos) == filter(v, pos));
+    CHECK(reject(policy, v, pos) == reject(v, pos));
+
+    // the order of the kept elements is kept, even where every block keeps a different number
+    const auto rare = [](int x) {return x == 499;};
+    CHECK(filter(policy, v, rare) == filter(v, rare));
+
+    CHECK(fff::some(policy, v, [](int x) {return x == 499;}));
+    CHECK(not fff::some(policy, v, [](int x) {return x > 1000;}));
+    CHECK(fff::every(policy, v, [](int x) {return x < 500;}));
+    CHECK(not fff::every(policy, v, pos));
+    CHECK(fff::none(policy, v, [](int x) {return x > 1000;}));
+    CHECK(not fff::none(policy, v, pos));
+
+    std::vector<int> w = v;
+    each(policy, w, [](int &x) {x += 1;});
+    CHECK(map(v, [](int x) {return x + 1;}) == w);
+
+    // a container that cannot be split runs sequentially
+    const std::list<int> l(v.begin(), v.begin() + 1000);
+    CHECK(map(policy, l, sq) == map(l, sq));
+    CHECK(filter(policy, l, pos) == filter(l, pos));
+    CHECK(fff::some(policy, l, pos));
+
+    // an exception thrown in any block reaches the caller
+    CHECK_THROWS(std::runtime_error, map(policy, v, [](int x) {
+        if (x == 499) {
+            throw std::runtime_error("bad element");
+        }
+        return x;
+    }));
+
+    // an empty container
+    const std::vector<int> e;
+    CHECK(map(policy, e, sq).empty());
+    CHECK(filter(policy, e, pos).empty());
+    CHECK(fff::every(policy, e, pos));
+    CHECK(not fff::some(policy, e, pos));
+}
+
+int main() {
+    same_as_seq(execution::seq);
+    same_as_seq(execution::unseq);
+    same_as_seq(execution::par);
+    same_as_seq(execution::par_unseq);
+
+    // every element is visited exactly once
+    std::vector<int> v(50'000, 1);
+    std::atomic<long> visits = 0;
+    each(execution::par, v, [&visits](int &) {++visits;});
+    CHECK(visits == 50'000);
+
+    return fff_test::result();
+}
@@ -0,0 +1,64 @@
+#include <array>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "ffffff/reducible.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+template<class Policy>
+void same_as_seq(Policy policy) {
+    std::vector<int> v(100'003);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>(i * 7919 % 2001) - 1000;
+    }
+    const long long want = std::accumulate(v.begin(), v.end(), 5LL);
+
+    CHECK(fff::reduce(policy, v, std::plus<>(), 5LL) == want);
+    CHECK(fff::reduce(policy, v, std::plus<>(), 5) == static_cast<int>(want));
+    CHECK(fff::reduce(policy, v, fff::reducible(std::plus<>()), 5) == static_cast<int>(want));
+    CHECK(fff::reduce(policy, v, std::bit_xor<>(), 0) == fff::reduce(v, std::bit_xor<>(), 0));
+
+    // associative but not commutative : the blocks are combined in order
+    std::vector<std::string> words(20'000);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] = std::to_string(i % 10);
+    }
+    CHECK(fff::reduce(policy, words, std::plus<>(), std::string(">")) == fff::reduce(words, std::plus<>(), std::string(">")));
+
+    // not associative : folded from the left, whatever the policy
+    CHECK(fff::reduce(policy, v, std::minus<>(), 0LL) == -want + 5);
+
+    // std::plus<U> of another U converts every operand to U, as the sequential fold does; no SIMD sum of doubles
+    CHECK(fff::reduce(policy, std::vector<double>{1.5, 2.5}, std::plus<int>(), 0.0) == 3.0);
+    CHECK(fff::reduce(policy, std::vector<float>{1.5f, 2.5f}, std::plus<int>(), 0.0f) == 3.0f);
+    CHECK(fff::reduce(policy, std::vector<double>(50'000, 1.5), std::plus<int>(), 0.0) == 50'000.0);
+    CHECK(fff::reduce(policy, std::vector<double>{1.5, 2.5}, fff::reducible(std::plus<int>()), 0.0) == 3.0);
+    CHECK(fff::reduce(policy, std::vector<int>{1, 2}, std::plus<double>(), 0.5) == 3.5);
+
+    // a float sum is the sum, up to rounding
+    std::vector<float> f(10'000, 0.25f);
+    CHECK(fff::reduce(policy, f, std::plus<>(), 0.f) == 2500.f);
+    CHECK(fff::reduce(policy, f, std::plus<float>(), 1.f) == 2501.f);
+
+    // anything else
+    const std::list<int> l{1, 2, 3};
+    CHECK(fff::reduce(policy, l, std::multiplies<>(), 2) == 12);
+    CHECK(fff::reduce(policy, std::vector<int>{}, std::plus<>(), 7) == 7);
+}
+
+int main() {
+    same_as_seq(execution::seq);
+    same_as_seq(execution::par);
+    same_as_seq(execution::par_unseq);
+
+    static_assert(fff::reduce(std::array{1, 2, 3}, std::plus<>(), 0) == 6);
+
+    return fff_test::result();
+}
@@ -0,0 +1,76 @@
+#include <functional>
+#include <string>
+
+#include "ffffff/reducible.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* An associative op that shows how it was grouped.
+*/
+struct group_f {
+    std::string operator()(const std::string &a, const std::string &b) const {
+        return "(" + a + b + ")";
+    }
+};
+
+template<>
+struct fff::is_associative<group_f> : std::true_type {};
+
+/*
+* A value that counts its copies.
+*/
+struct counted {
+    inline static int copies = 0;
+    int v = 0;
+
+    counted(int v) : v(v) {}
+    counted(const counted &other) : v(other.v) { ++copies; }
+    counted(counted &&) noexcept = default;
+    counted &operator=(const counted &) = default;
+    counted &operator=(counted &&) noexcept = default;
+
+    friend counted operator+(const counted &a, const counted &b) {
+        return counted(a.v + b.v);
+    }
+};
+
+template<>
+struct fff::is_associative<std::plus<counted>> : std::true_type {};
+
+int main() {
+    const std::string a = "a", b = "b", c = "c", d = "d", e = "e";
+
+    // an associative op over arguments of one type is folded as a balanced tree
+    CHECK(fff::reducible(group_f())(a, b, c, d) == "((ab)(cd))");
+    CHECK(fff::reducible(group_f())(a, b, c, d, e) == "((ab)(c(de)))");
+    CHECK(fff::reducible(execution::par, group_f())(a, b, c, d, e) == "((ab)(c(de)))");
+    CHECK(fff::reducible(std::plus<>())(1, 2, 3, 4, 5) == 15);
+
+    // anything else from the left, as it was before the balanced fold : a string literal never meets another one
+    CHECK(fff::reducible(std::plus<>())(std::string("a"), "b", "c") == "abc");
+    CHECK(fff::reducible(std::plus<>())(std::string("a"), "b", "c", "d", "e") == "abcde");
+    CHECK(fff::reducible(execution::par, std::plus<>())(std::string("a"), "b", "c", "d") == "abcd");
+    CHECK(fff::reducible(std::plus<>())(0.5, 1, 2) == 3.5);
+
+    // a non-associative op is always folded from the left, and parallel policies do not take one
+    CHECK(fff::reducible(std::minus<>())(10, 1, 2, 3) == 4);
+    CHECK(fff::reducible(execution::seq, std::minus<>())(10, 1, 2, 3) == 4);
+    static_assert(not std::is_invocable_v<const fff::factory::Reducible &, const execution::parallel_policy &, std::minus<>>);
+    static_assert(not std::is_invocable_v<const fff::factory::Reducible &, const execution::parallel_unsequenced_policy &, std::minus<>>);
+    static_assert(std::is_invocable_v<const fff::factory::Reducible &, const execution::parallel_policy &, std::plus<>>);
+    static_assert(not fff::is_associative_v<decltype(fff::reducible(execution::seq, std::minus<>()))>);
+
+    // the parallel fold gives what the sequential one gives
+    CHECK(fff::reducible(execution::par, std::plus<>())(a, b, c, d, e, a, b, c, d, e) == "abcdeabcde");
+
+    // every rvalue argument is forwarded, never copied
+    counted::copies = 0;
+    const counted sum = fff::reducible(std::plus<counted>())(counted(1), counted(2), counted(3), counted(4));
+    CHECK(sum.v == 10);
+    CHECK(counted::copies == 0);
+
+    return fff_test::result();
+}
@@ -0,0 +1,107 @@
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ffffff/reducible.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* n numbers of many magnitudes, the same on every machine, so that the order of the additions shows in the sum.
+*/
+template<typename T>
+std::vector<T> numbers(std::size_t n) {
+    std::vector<T> v(n);
+    std::uint64_t s = 12345;
+    for (auto &x : v) {
+        s = s * 6364136223846793005ULL + 1442695040888963407ULL;
+        const double m = static_cast<double>(s >> 11) / 9007199254740992.0 - 0.5;
+        x = static_cast<T>(std::ldexp(m, static_cast<int>((s >> 20) % 16) - 8));
+    }
+    return v;
+}
+
+/*
+* whether fff::reduce takes op with fff::reproducible
+*/
+template<class Op>
+constexpr bool reproducible_with = requires (const std::vector<int> &v, Op op) {
+    fff::reduce(v, op, 0, fff::reproducible);
+};
+
+// the leaves are combined as a tree, so a non-associative op is rejected
+static_assert(reproducible_with<std::plus<>>);
+static_assert(not reproducible_with<std::minus<>>);
+
+template<typename T, class ...How>
+auto bits(const std::vector<T> &v, How ...how) {
+    using U = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+
+    const T seq = fff::reduce(execution::seq, v, std::plus<>(), T(0), how...);
+    const T par = fff::reduce(execution::par, v, std::plus<>(), T(0), how...);
+    const T par_unseq = fff::reduce(execution::par_unseq, v, std::plus<>(), T(0), how...);
+
+    // the same for every policy and every number of workers
+    CHECK(std::bit_cast<U>(seq) == std::bit_cast<U>(par));
+    CHECK(std::bit_cast<U>(seq) == std::bit_cast<U>(par_unseq));
+    return std::bit_cast<U>(seq);
+}
+
+int main() {
+    if (not fff_test::target_supported()) {
+        return fff_test::skipped;
+    }
+
+    // The same bits on every target : this test is also built with -mavx2, and both builds check the same numbers.
+    {
+        const auto d = numbers<double>(100'003);
+        const auto f = numbers<float>(100'003);
+        CHECK(bits(d, fff::reproducible) == 0xc0889f165e18152eULL);
+        CHECK(bits(d, fff::reproducible_compensated) == 0xc0889f165e181561ULL);
+        CHECK(bits(f, fff::reproducible) == 0xc444f8c0U);
+        CHECK(bits(f, fff::reproducible_compensated) == 0xc444f8b4U);
+    }
+    {
+        const auto d = numbers<double>(1'000'000);
+        const auto f = numbers<float>(1'000'000);
+        CHECK(bits(d, fff::reproducible) == 0xc0c50f2984dab882ULL);
+        CHECK(bits(d, fff::reproducible_compensated) == 0xc0c50f2984dab8a5ULL);
+        CHECK(bits(f, fff::reproducible) == 0xc6287950U);
+        CHECK(bits(f, fff::reproducible_compensated) == 0xc628794cU);
+
+        // the plain sequential SIMD sum is the same on every target too
+        CHECK(std::bit_cast<std::uint64_t>(fff::reduce(d, std::plus<>(), 0.0)) == 0xc0c50f2984dabcc4ULL);
+
+        // the compensated sum is as good as a sum in twice the precision
+        long double exact = 0;
+        for (double x : d) {
+            exact += x;
+        }
+        const double comp = fff::reduce(execution::par, d, std::plus<>(), 0.0, fff::reproducible_compensated);
+        CHECK(std::abs(static_cast<long double>(comp) - exact) <= std::abs(exact) * 1e-15L);
+    }
+
+    // sizes around a row of columns, a leaf, and none at all
+    for (std::size_t n : {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 4095u, 4096u, 4097u, 8193u}) {
+        const auto d = numbers<double>(n);
+        const auto f = numbers<float>(n);
+        bits(d, fff::reproducible);
+        bits(d, fff::reproducible_compensated);
+        bits(f, fff::reproducible);
+        bits(f, fff::reproducible_compensated);
+    }
+
+    // any other op, folded in the same fixed tree
+    std::vector<int> v(50'000);
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<int>(i % 7) + 1;
+    }
+    CHECK(fff::reduce(execution::par, v, std::bit_xor<>(), 0, fff::reproducible) == fff::reduce(v, std::bit_xor<>(), 0));
+    CHECK(fff::reduce(execution::par, v, std::plus<>(), 0, fff::reproducible) == fff::reduce(v, std::plus<>(), 0));
+
+    return fff_test::result();
+}
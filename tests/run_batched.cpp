@@ -0,0 +1,74 @@
+#include <list>
+#include <string>
+#include <vector>
+
+#include "ffffff/pipeline.hpp"
+
+#include "check.hpp"
+
+/**
+* a stage result with no default constructor, which the batches build by push_back
+*/
+struct tagged {
+    int v;
+    explicit tagged(int v) : v(v) {}
+};
+
+int main() {
+    std::vector<int> in(1000);
+    for (int i = 0; i < 1000; ++i) {
+        in[i] = i * 7 % 13 - 6;
+    }
+
+    const auto p = fff::pipeline
+        | [](int x) {return x * 3;}
+        | [](int x) {return std::to_string(x);}
+        | [](const std::string &s) {return s.size();};
+
+    // the same results as operator(), in order, for any batch size
+    std::vector<std::size_t> expected;
+    for (int x : in) {
+        expected.push_back(p(x));
+    }
+    for (std::size_t batch : {0u, 1u, 7u, 256u, 1000u, 5000u}) {
+        CHECK(p.run_batched(in, batch) == expected);
+    }
+    CHECK(p.run_batched(std::vector<int>()).empty());
+
+    // a stage that makes bool, in the middle and at the end (std::vector<bool> buffers)
+    {
+        const auto q = fff::pipeline
+            | [](int x) {return x > 0;}
+            | [](bool b) {return b ? 10 : -10;}
+            | [](int x) {return x == 10;};
+        std::vector<bool> want;
+        for (int x : in) {
+            want.push_back(q(x));
+        }
+        CHECK(q.run_batched(in, 64) == want);
+
+        const auto r = fff::pipeline | [](int x) {return x % 2 == 0;};
+        std::vector<bool> even;
+        for (int x : in) {
+            even.push_back(x % 2 == 0);
+        }
+        CHECK(r.run_batched(in, 3) == even);
+    }
+
+    // a stage result that is not default-constructible, from a range that is not contiguous
+    {
+        const std::list<int> l(in.begin(), in.end());
+        const auto q = fff::pipeline
+            | [](int x) {return tagged(x + 1);}
+            | [](const tagged &t) {return t.v * 2;};
+        const auto out = q.run_batched(l, 100);
+        CHECK(out.size() == in.size());
+        bool same = true;
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            same = same and out[i] == (in[i] + 1) * 2;
+        }
+        CHECK(same);
+    }
+
+    return fff_test::result();
+}
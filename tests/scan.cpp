@@ -0,0 +1,87 @@
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "ffffff/scan.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* The plain sequential loops that fff::scan and fff::exclusive_scan must match.
+*/
+template<typename T, class R, class Op>
+std::vector<T> inclusive(const R &r, const Op &op, T acc) {
+    std::vector<T> ret;
+    for (const auto &x : r) {
+        acc = op(acc, x);
+        ret.push_back(acc);
+    }
+    return ret;
+}
+
+template<typename T, class R, class Op>
+std::vector<T> exclusive(const R &r, const Op &op, T acc) {
+    std::vector<T> ret;
+    for (const auto &x : r) {
+        ret.push_back(acc);
+        acc = op(acc, x);
+    }
+    return ret;
+}
+
+template<class Policy>
+void same_as_loop(Policy policy) {
+    for (std::size_t n : {0u, 1u, 3u, 4u, 5u, 8u, 17u, 4096u, 100'003u}) {
+        std::vector<int> v(n);
+        std::vector<float> f(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = static_cast<int>(i * 7919 % 201) - 100;
+            f[i] = static_cast<float>(v[i]) * 0.25f; // every partial sum is exact
+        }
+
+        CHECK(fff::scan(policy, v, std::plus<>()) == inclusive(v, std::plus<>(), 0));
+        CHECK(fff::scan(policy, v, std::plus<>(), 7) == inclusive(v, std::plus<>(), 7));
+        CHECK(fff::exclusive_scan(policy, v, std::plus<>(), 7) == exclusive(v, std::plus<>(), 7));
+        CHECK(fff::scan(policy, f, std::plus<>(), 1.f) == inclusive(f, std::plus<>(), 1.f));
+        CHECK(fff::exclusive_scan(policy, f, std::plus<float>(), 1.f) == exclusive(f, std::plus<float>(), 1.f));
+        CHECK(fff::scan(policy, v, std::plus<>(), 0LL) == inclusive(v, std::plus<>(), 0LL));
+        CHECK(fff::exclusive_scan(policy, v, std::bit_xor<>(), 0) == exclusive(v, std::bit_xor<>(), 0));
+
+        // not associative : scanned in one pass, whatever the policy
+        CHECK(fff::scan(policy, v, std::minus<>(), 0) == inclusive(v, std::minus<>(), 0));
+
+        // std::plus<int> over floats converts every operand to int, as the loop does; no SIMD prefix sum of floats
+        CHECK(fff::scan(policy, f, std::plus<int>(), 0.5f) == inclusive(f, std::plus<int>(), 0.5f));
+        CHECK(fff::exclusive_scan(policy, f, std::plus<int>(), 0.5f) == exclusive(f, std::plus<int>(), 0.5f));
+    }
+
+    CHECK(fff::scan(policy, std::vector<float>{1.5f, 2.5f}, std::plus<int>(), 0.0f) == std::vector<float>{1.f, 3.f});
+
+    // associative but not commutative : the blocks are joined in order
+    std::vector<std::string> words(10'000);
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] = std::string(1, static_cast<char>('a' + i % 26));
+    }
+    const auto cat = fff::scan(policy, words, std::plus<>(), std::string());
+    CHECK(cat.size() == words.size());
+    CHECK(cat[25] == "abcdefghijklmnopqrstuvwxyz" and cat.back().size() == words.size());
+    CHECK(cat == inclusive(words, std::plus<>(), std::string()));
+
+    const std::list<int> l{1, 2, 3};
+    CHECK(fff::scan(policy, l, std::multiplies<>()) == std::vector<int>{1, 2, 6});
+    CHECK(fff::exclusive_scan(policy, l, std::plus<>(), 0) == std::vector<int>{0, 1, 3});
+}
+
+int main() {
+    if (not fff_test::target_supported()) {
+        return fff_test::skipped;
+    }
+
+    same_as_loop(execution::seq);
+    same_as_loop(execution::par);
+
+    return fff_test::result();
+}
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "ffffff/bind.hpp"
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+namespace {
+    constexpr fff::Filter filter;
+    constexpr fff::Reject reject;
+}
+
+/*
+* Every filter of a compactable range gives what the plain loop gives, for every size and every policy.
+*/
+template<typename T, class P>
+void same_as_scalar(const P &p, const std::vector<T> &pattern) {
+    for (std::size_t n : {0u, 1u, 7u, 8u, 9u, 31u, 64u, 65u, 200u, 20'011u}) {
+        std::vector<T> v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = pattern[i * 7 % pattern.size()];
+        }
+
+        std::vector<T> keep, drop;
+        for (const T &x : v) {
+            (p(x) ? keep : drop).push_back(x);
+        }
+
+        const auto same = [](const std::vector<T> &a, const std::vector<T> &b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < a.size(); ++i) {
+                if (not (a[i] == b[i] or (std::isnan(static_cast<double>(a[i])) and std::isnan(static_cast<double>(b[i]))))) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        CHECK(same(filter(v, p), keep));
+        CHECK(same(reject(v, p), drop));
+        CHECK(same(filter(execution::par, v, p), keep));
+        CHECK(same(reject(execution::par, v, p), drop));
+        CHECK(same(filter(std::vector<T>(v), p), keep));
+        CHECK(same(reject(std::vector<T>(v), p), drop));
+        CHECK(same(filter(execution::par, std::vector<T>(v), p), keep));
+    }
+}
+
+template<typename T>
+void every_comparison(const std::vector<T> &pattern) {
+    same_as_scalar<T>(fff::static_r_bind<0>(std::less<>()), pattern);
+    same_as_scalar<T>(fff::static_r_bind<0>(std::less_equal<>()), pattern);
+    same_as_scalar<T>(fff::static_r_bind<0>(std::greater<>()), pattern);
+    same_as_scalar<T>(fff::static_r_bind<0>(std::greater_equal<>()), pattern);
+    same_as_scalar<T>(fff::static_r_bind<0>(std::equal_to<>()), pattern);
+    same_as_scalar<T>(fff::static_r_bind<0>(std::not_equal_to<>()), pattern);
+    same_as_scalar<T>(fff::static_l_bind<0>(std::less<>()), pattern);
+    same_as_scalar<T>(fff::static_l_bind<0>(std::greater_equal<>()), pattern);
+    // any other predicate over arithmetic elements is still compacted without a branch
+    same_as_scalar<T>([](T x) {return static_cast<long long>(x) % 3 == 0;}, pattern);
+}
+
+int main() {
+    if (not fff_test::target_supported()) {
+        return fff_test::skipped;
+    }
+
+    every_comparison<int>({3, -1, 0, 7, -8, 0, 2, -5, 11, 0, -2});
+    every_comparison<float>({1.5f, -0.5f, 0.f, -0.f, 2.f, std::numeric_limits<float>::quiet_NaN(), -3.f});
+    every_comparison<double>({1.5, -0.5, 0., -0., std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()});
+
+    return fff_test::result();
+}
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ffffff/bind.hpp"
+#include "ffffff/functors.hpp"
+
+#include "check.hpp"
+
+namespace execution = fff::execution;
+
+/*
+* A map with a SIMD kernel gives what the scalar loop gives, for every size (so for every tail length).
+*/
+template<typename T, class F>
+void same_as_scalar(const F &f) {
+    for (std::size_t n = 0; n < 70; ++n) {
+        std::vector<T> v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = static_cast<T>(static_cast<int>(i * 37 % 101) - 50);
+        }
+
+        std::vector<T> want(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            want[i] = f(v[i]);
+        }
+
+        CHECK(fff::map(v, f) == want);
+        CHECK(fff::map(execution::par, v, f) == want);
+        CHECK(fff::map(std::vector<T>(v), f) == want);
+
+        std::vector<T> out(n + 3, T(7));
+        const auto got = fff::map_into(std::span(out), v, f);
+        CHECK(std::vector<T>(got.begin(), got.end()) == want);
+        CHECK(out[n] == T(7));
+    }
+
+    std::vector<T> big(100'003, T(3));
+    CHECK(fff::map(execution::par, big, f) == std::vector<T>(big.size(), f(T(3))));
+}
+
+int main() {
+    if (not fff_test::target_supported()) {
+        return fff_test::skipped;
+    }
+
+    same_as_scalar<int>(fff::static_r_bind<3>(std::plus<>()));
+    same_as_scalar<int>(fff::static_r_bind<3>(std::minus<>()));
+    same_as_scalar<int>(fff::static_l_bind<3>(std::minus<>()));
+    same_as_scalar<int>(fff::static_r_bind<-4>(std::multiplies<>()));
+    same_as_scalar<int>(fff::flip);
+    same_as_scalar<std::uint32_t>(fff::flip);
+
+    same_as_scalar<float>(fff::static_r_bind<2>(std::plus<>()));
+    same_as_scalar<float>(fff::static_l_bind<1>(std::minus<>()));
+    same_as_scalar<float>(fff::static_r_bind<3>(std::multiplies<>()));
+
+    same_as_scalar<double>(fff::static_r_bind<2>(std::minus<>()));
+    same_as_scalar<double>(fff::static_r_bind<-1>(std::multiplies<>()));
+
+    // the bound constant is converted as the operator converts it
+    same_as_scalar<int>(fff::static_r_bind<2.5>(std::plus<int>()));
+
+#if defined(__SSE2__)
+    static_assert(fff::simd::kernel_for<int, decltype(fff::static_r_bind<3>(std::plus<>()))>);
+    static_assert(fff::simd::kernel_for<double, decltype(fff::static_r_bind<3>(std::multiplies<>()))>);
+#endif
+    // no kernel for a result of another type
+    static_assert(not fff::simd::kernel_for<double, decltype(fff::static_r_bind<3>(std::plus<int>()))>);
+
+    return fff_test::result();
+}
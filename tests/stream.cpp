@@ -0,0 +1,90 @@
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ffffff/stream.hpp"
+
+#include "check.hpp"
+
+int main() {
+    // every value comes out, through every stage, in order; a small queue only makes the stages wait
+    for (std::size_t capacity : {2u, 1024u}) {
+        auto s = fff::stream<int>(fff::pipeline
+            | [](int x) {return x * 2;}
+            | [](int x) {return std::to_string(x);}
+            | [](const std::string &str) {return str + "!";}, capacity);
+
+        std::thread feeder([&s] {
+            for (int i = 0; i < 10'000; ++i) {
+                s.push(i);
+            }
+            s.close();
+        });
+
+        std::vector<std::string> out;
+        while (auto x = s.pop()) {
+            out.push_back(std::move(*x));
+        }
+        feeder.join();
+        s.wait();
+
+        bool in_order = out.size() == 10'000;
+        for (std::size_t i = 0; in_order and i < out.size(); ++i) {
+            in_order = out[i] == std::to_string(2 * i) + "!";
+        }
+        CHECK(in_order);
+
+        const auto stats = s.stats();
+        CHECK(stats.size() == 4);
+        CHECK(stats.front().pushed == 10'000);
+        CHECK(stats.back().pushed == 10'000);
+        CHECK(stats.front().capacity == capacity);
+    }
+
+    // a last stage that returns void has nothing to pop
+    {
+        long sum = 0;
+        auto s = fff::stream<int>(fff::pipeline | [](int x) {return x + 1;} | [&sum](int x) {sum += x;}, 8);
+        for (int i = 0; i < 100; ++i) {
+            s.push(i);
+        }
+        s.wait();
+        CHECK(sum == 5050);
+        CHECK(s.stats().size() == 2);
+    }
+
+    // once a stage throws, push() gives up even while its queue has room, and wait() rethrows
+    {
+        auto s = fff::stream<int>(fff::pipeline
+            | [](int x) {
+                if (x < 0) {
+                    throw std::runtime_error("negative");
+                }
+                return x;
+            }
+            | [](int x) {return x;}, 1 << 16);
+
+        CHECK(s.push(-1));
+        int accepted = 0;
+        while (accepted < 2000 and s.push(1)) {
+            ++accepted;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(accepted < 2000);
+        CHECK(not s.push(1));
+        CHECK_THROWS(std::runtime_error, s.wait());
+    }
+
+    // a stream dropped before it is drained stops, with no one popping its output
+    {
+        auto s = fff::stream<int>(fff::pipeline | [](int x) {return x;} | [](int x) {return x;}, 2);
+        for (int i = 0; i < 4; ++i) {
+            CHECK(s.push(i));
+        }
+        CHECK(s.pop() == 0);
+    }
+
+    return fff_test::result();
+}
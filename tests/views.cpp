@@ -0,0 +1,46 @@
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ffffff/pipeline.hpp"
+#include "ffffff/views.hpp"
+
+#include "check.hpp"
+
+using namespace fff::pipe_op;
+namespace views = fff::views;
+
+int main() {
+    const std::vector<int> v{1, 2, 3, 4, 5, 6};
+    const auto twice = [](int x) {return x * 2;};
+    const auto odd = [](int x) {return x % 2 == 1;};
+
+    // a chain collects in one pass, in order
+    CHECK((v | views::map(twice) | views::collect) == std::vector<int>{2, 4, 6, 8, 10, 12});
+    CHECK((v | views::filter(odd) | views::map(twice) | views::collect) == std::vector<int>{2, 6, 10});
+    CHECK((v | views::reject(odd) | views::to<std::list>) == std::list<int>{2, 4, 6});
+    CHECK((v | views::map([](int x) {return x % 3;}) | views::to<std::set>) == std::set<int>{0, 1, 2});
+
+    // the value type follows the stages
+    auto s = v | views::map([](int x) {return std::to_string(x);}) | views::filter([](const std::string &x) {return x != "3";});
+    CHECK((s | views::collect) == std::vector<std::string>{"1", "2", "4", "5", "6"});
+
+    // nothing runs until the chain is collected, and every element runs through all stages once
+    int calls = 0;
+    auto lazy = v | views::map([&calls](int x) {++calls; return x;}) | views::filter(odd);
+    CHECK(calls == 0);
+    CHECK((lazy | views::collect).size() == 3);
+    CHECK(calls == 6);
+
+    // an rvalue base is owned by the chain
+    auto owned = std::vector<int>{3, 4} | views::map(twice);
+    CHECK((owned | views::collect) == std::vector<int>{6, 8});
+
+    // a chain without the base is a reusable stage of a pipeline
+    auto g = fff::pipeline | views::map(twice) | views::reject(odd) | views::collect;
+    CHECK(g(v) == std::vector<int>{2, 4, 6, 8, 10, 12});
+    CHECK(g(std::vector<int>{}).empty());
+
+    return fff_test::result();
+}
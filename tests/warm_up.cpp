@@ -0,0 +1,78 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+
+#include "ffffff/utils.hpp"
+
+#include "check.hpp"
+
+int main() {
+    // warm_up runs an eager once in the background, and a later call finds the result there
+    {
+        std::atomic<int> runs = 0;
+        auto o = fff::once(fff::eager, [&runs] {++runs; return 42;});
+        {
+            fff::executor ex(2);
+            CHECK(fff::warm_up(ex) >= 1);
+        } // joins the warm-up tasks
+        CHECK(runs == 1);
+        CHECK(o() == 42);
+        CHECK(runs == 1);
+    }
+
+    // a once destroyed before its warm-up task runs is skipped, not touched
+    {
+        std::atomic<int> runs = 0;
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        {
+            fff::executor ex(1);
+            ex.submit([opened] { opened.wait(); }); // holds the only worker
+
+            {
+                std::optional o{fff::once(fff::eager, [&runs] {return ++runs;})};
+                CHECK(fff::warm_up(ex) >= 1);
+            }
+            gate.set_value();
+        }
+        CHECK(runs == 0);
+    }
+
+    // destroying a once waits for the warm-up that is running it
+    {
+        std::atomic<bool> started = false, finished = false;
+        std::atomic<bool> finished_first = false;
+        {
+            fff::executor ex(1);
+            {
+                auto o = fff::once(fff::eager, [&] {
+                    started = true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    finished = true;
+                    return 1;
+                });
+                fff::warm_up(ex);
+                while (not started) {
+                    std::this_thread::yield();
+                }
+            }
+            finished_first = finished.load();
+        }
+        CHECK(finished_first);
+    }
+
+    // a lazy once is not warmed up
+    {
+        int runs = 0;
+        auto o = fff::once([&runs] {return ++runs;});
+        {
+            fff::executor ex(1);
+            fff::warm_up(ex);
+        }
+        CHECK(runs == 0);
+    }
+
+    return fff_test::result();
+}